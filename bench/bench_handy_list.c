@@ -0,0 +1,342 @@
+// bench_handy_list - cost of every handy_list operation per list variant,
+// list size and access pattern
+//
+//   cc -O2 -std=c11 -I.. bench_handy_list.c ../handy_list.c
+//      ../handy_chunk_list.c ../handy_deque_list.c ../handy_small_list.c
+//      -o bench_handy_list -lpthread
+//   ./bench_handy_list [ max_size [ ms_per_case [ variant ] ] ]
+//
+// Linking with
+//
+//   -DBENCH_COUNT_MALLOC -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=aligned_alloc
+//
+// also counts the heap allocations each case makes; otherwise that column
+// reads -1.
+//
+// Sizes run 10, 100 .. max_size ( default 10M ). Each case builds a list of
+// the size with add_back ( untimed, except for the add cases themselves )
+// and then repeats its operation until it has done it size times or used
+// ms_per_case ( default 200 ), whichever comes first. One CSV line per case:
+//
+//   variant,op,pattern,size,ops,ns_per_op,allocs_per_op,rss_kb
+//
+// pattern is seq ( positions in order, or the list's own end ), random
+// ( uniform positions or items ) or queue ( add_back + rem_front pairs at a
+// steady size ). rss_kb is the resident set after the case, list still
+// alive. A new variant is one more line in bench_variants.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../handy_list.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// variants
+
+static handy_list bench_create_node     ()
+{
+    return handy_create_list();
+}
+static handy_list bench_create_indexed  ()
+{
+    return handy_create_list_with( HANDY_LIST_INDEXED );
+}
+static handy_list bench_create_hashed   ()
+{
+    return handy_create_list_with( HANDY_LIST_HASHED );
+}
+static handy_list bench_create_small    ()
+{
+    return handy_create_small_list( 0 );
+}
+
+static const struct
+{
+    const char * name;
+    handy_list (*create)();
+} bench_variants[] =
+{
+    { "node",    bench_create_node },
+    { "indexed", bench_create_indexed },
+    { "hashed",  bench_create_hashed },
+    { "chunk",   handy_create_chunk_list },
+    { "deque",   handy_create_deque_list },
+    { "small",   bench_create_small },
+};
+
+#define BENCH_VARIANTS ( (int)( sizeof( bench_variants ) / sizeof( bench_variants[0] ) ) )
+
+// allocation counting
+
+static long bench_allocs = 0;
+
+#ifdef BENCH_COUNT_MALLOC
+void * __real_malloc        ( size_t bytes );
+void * __real_calloc        ( size_t count, size_t bytes );
+void * __real_realloc       ( void * block, size_t bytes );
+void * __real_aligned_alloc ( size_t align, size_t bytes );
+
+void * __wrap_malloc        ( size_t bytes )
+{
+    bench_allocs++;
+    return __real_malloc( bytes );
+}
+void * __wrap_calloc        ( size_t count, size_t bytes )
+{
+    bench_allocs++;
+    return __real_calloc( count, bytes );
+}
+void * __wrap_realloc       ( void * block, size_t bytes )
+{
+    bench_allocs++;
+    return __real_realloc( block, bytes );
+}
+void * __wrap_aligned_alloc ( size_t align, size_t bytes )
+{
+    bench_allocs++;
+    return __real_aligned_alloc( align, bytes );
+}
+#endif
+
+// clock, random numbers, memory
+
+static double bench_now     ()
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static uint64_t bench_seed = 88172645463325252ull;
+
+static int  bench_random    ( int below )
+{
+    // xorshift64
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return below > 0 ? (int)( bench_seed % (uint64_t) below ) : 0;
+}
+static long bench_rss_kb    ()
+{
+    FILE * statm = fopen( "/proc/self/statm", "r" );
+    long   total, pages = 0;
+
+    if( statm != NULL )
+    {
+        if( fscanf( statm, "%ld %ld", &total, &pages ) != 2 )
+            pages = 0;
+        fclose( statm );
+    }
+    if( pages > 0 )
+        return pages * ( sysconf( _SC_PAGESIZE ) / 1024 );
+
+    // no /proc: fall back to the peak
+    struct rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+    return usage.ru_maxrss;
+}
+
+static void * bench_item    ( int i )
+{
+    return (void *)(uintptr_t)( i + 1 );
+}
+static handy_list bench_build ( int variant, int size )
+{
+    handy_list list = bench_variants[ variant ].create();
+
+    for( int i = 0; i < size; i++ )
+        handy_list_add_back( list, bench_item( i ) );
+    handy_list_index_refresh( list );
+    return list;
+}
+
+// cases: each one repeats its operation up to limit times and returns how
+// many it did. The clock is read every 64 operations.
+
+static double bench_deadline;
+
+#define BENCH_LOOP( i, limit ) \
+    for( i = 0; i < ( limit ) && ( ( i & 63 ) != 0 || bench_now() < bench_deadline ); i++ )
+
+static long bench_add_back      ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_add_back( list, bench_item( i ) );
+    return i;
+}
+static long bench_add_front     ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_add_front( list, bench_item( i ) );
+    return i;
+}
+static long bench_add_at        ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_add_at( list, bench_item( i ), bench_random( handy_list_length( list ) + 1 ) );
+    return i;
+}
+static long bench_get_front     ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_get_front( list );
+    return i;
+}
+static long bench_get_back      ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_get_back( list );
+    return i;
+}
+static long bench_get_at_seq    ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_get_at( list, (int) i );
+    return i;
+}
+static long bench_get_at_random ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_get_at( list, bench_random( size ) );
+    return i;
+}
+static long bench_contain       ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_contain( list, bench_item( bench_random( size ) ) );
+    return i;
+}
+static long bench_rem_front     ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_rem_front( list );
+    return i;
+}
+static long bench_rem_back      ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_rem_back( list );
+    return i;
+}
+static long bench_rem_at        ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_rem_at( list, bench_random( handy_list_length( list ) ) );
+    return i;
+}
+static long bench_queue         ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+    {
+        handy_list_add_back( list, bench_item( i ) );
+        handy_list_rem_front( list );
+    }
+    return i;
+}
+static long bench_reverse       ( handy_list list, int size )
+{
+    long i;
+    BENCH_LOOP( i, size )
+        handy_list_reverse( list );
+    return i;
+}
+static long bench_free          ( handy_list list, int size )
+{
+    (void) size;
+    handy_list_free( list );
+    return 1;
+}
+
+static const struct
+{
+    const char * op;
+    const char * pattern;
+    long (*run)( handy_list list, int size );
+    bool         empty;             // starts from an empty list
+} bench_cases[] =
+{
+    { "add_back",  "seq",    bench_add_back,      true },
+    { "add_front", "seq",    bench_add_front,     true },
+    { "add_at",    "random", bench_add_at,        false },
+    { "get_front", "seq",    bench_get_front,     false },
+    { "get_back",  "seq",    bench_get_back,      false },
+    { "get_at",    "seq",    bench_get_at_seq,    false },
+    { "get_at",    "random", bench_get_at_random, false },
+    { "contain",   "random", bench_contain,       false },
+    { "rem_front", "seq",    bench_rem_front,     false },
+    { "rem_back",  "seq",    bench_rem_back,      false },
+    { "rem_at",    "random", bench_rem_at,        false },
+    { "add_back",  "queue",  bench_queue,         false },
+    { "reverse",   "seq",    bench_reverse,       false },
+    { "free",      "seq",    bench_free,          false },
+};
+
+#define BENCH_CASES ( (int)( sizeof( bench_cases ) / sizeof( bench_cases[0] ) ) )
+
+int main( int argc, char ** argv )
+{
+    int          max_size = argc > 1 ? atoi( argv[1] ) : 10000000;
+    int          ms       = argc > 2 ? atoi( argv[2] ) : 200;
+    const char * only     = argc > 3 ? argv[3] : NULL;
+
+    printf( "variant,op,pattern,size,ops,ns_per_op,allocs_per_op,rss_kb\n" );
+
+    for( int variant = 0; variant < BENCH_VARIANTS; variant++ )
+    {
+        if( only != NULL && strcmp( only, bench_variants[ variant ].name ) != 0 )
+            continue;
+
+        for( int size = 10; size <= max_size; size *= 10 )
+        {
+            for( int c = 0; c < BENCH_CASES; c++ )
+            {
+                handy_list list = bench_build( variant, bench_cases[c].empty ? 0 : size );
+
+                long   allocs = bench_allocs;
+                double start = bench_now();
+
+                bench_deadline = start + ms / 1000.0;
+
+                long   ops = bench_cases[c].run( list, size );
+                double seconds = bench_now() - start;
+
+                allocs = bench_allocs - allocs;
+
+                printf( "%s,%s,%s,%d,%ld,%.2f,%.3f,%ld\n", bench_variants[ variant ].name,
+                        bench_cases[c].op, bench_cases[c].pattern, size, ops,
+                        ops > 0 ? seconds * 1e9 / ops : 0.0,
+#ifdef BENCH_COUNT_MALLOC
+                        ops > 0 ? (double) allocs / ops : 0.0,
+#else
+                        -1.0,
+#endif
+                        bench_rss_kb() );
+                fflush( stdout );
+
+                handy_list_free( list );
+                free( list );
+
+                // give the slabs back so one case's peak does not carry over
+                handy_list_pool_trim();
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+// bench_shared_list - read-mostly throughput of a handy_list shared
+// between threads, 1 to 64 threads
+//
+//   cc -O2 -std=c11 -I.. bench_shared_list.c ../handy_list.c
+//      ../handy_shared_list.c -o bench_shared_list -lpthread
+//   ./bench_shared_list [ size [ writes_per_1000 [ ms_per_run ] ] ]
+//
+// Every thread mixes contain, get_at and length with the given share of
+// add_back + rem_front pairs ( size stays put ). Three setups are timed:
+// the shared list, a plain list behind one pthread_rwlock, and a plain
+// list behind one global mutex ( what callers do today ). One CSV line is
+// printed per setup and thread count.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../handy_list.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+
+enum { BENCH_SHARED, BENCH_RWLOCK, BENCH_MUTEX };
+
+static const char * bench_names[] = { "shared", "rwlock", "mutex" };
+
+static handy_list       bench_list;
+static int              bench_kind;
+static int              bench_size;
+static int              bench_writes;
+static pthread_rwlock_t bench_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_mutex_t  bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool      bench_stop;
+static atomic_long      bench_ops;
+
+static void bench_lock      ( bool write )
+{
+    if( bench_kind == BENCH_RWLOCK )
+    {
+        if( write )
+            pthread_rwlock_wrlock( &bench_rwlock );
+        else
+            pthread_rwlock_rdlock( &bench_rwlock );
+    }
+    else if( bench_kind == BENCH_MUTEX )
+        pthread_mutex_lock( &bench_mutex );
+}
+static void bench_unlock    ()
+{
+    if( bench_kind == BENCH_RWLOCK )
+        pthread_rwlock_unlock( &bench_rwlock );
+    else if( bench_kind == BENCH_MUTEX )
+        pthread_mutex_unlock( &bench_mutex );
+}
+static void * bench_worker  ( void * arg )
+{
+    unsigned seed = (unsigned)(uintptr_t) arg * 2654435761u + 1;
+    long     ops = 0;
+
+    while( !atomic_load_explicit( &bench_stop, memory_order_relaxed ) )
+    {
+        seed = seed * 1103515245u + 12345u;
+        unsigned roll = ( seed >> 8 ) % 1000;
+        unsigned pick = ( seed >> 4 ) % bench_size;
+
+        if( roll < (unsigned) bench_writes )
+        {
+            bench_lock( true );
+            handy_list_add_back( bench_list, (void *)(uintptr_t) pick );
+            handy_list_rem_front( bench_list );
+            bench_unlock();
+        }
+        else
+        {
+            bench_lock( false );
+            switch( roll % 3 )
+            {
+            case 0:
+                handy_list_contain( bench_list, (void *)(uintptr_t) pick );
+                break;
+            case 1:
+                handy_list_get_at( bench_list, pick % bench_size );
+                break;
+            default:
+                handy_list_length( bench_list );
+                break;
+            }
+            bench_unlock();
+        }
+        ops++;
+    }
+    atomic_fetch_add( &bench_ops, ops );
+    return NULL;
+}
+
+int main( int argc, char ** argv )
+{
+    int ms;
+
+    bench_size   = argc > 1 ? atoi( argv[1] ) : 1024;
+    bench_writes = argc > 2 ? atoi( argv[2] ) : 10;
+    ms           = argc > 3 ? atoi( argv[3] ) : 500;
+
+    printf( "impl,threads,size,writes_per_1000,ops,seconds,mops_per_s\n" );
+
+    for( bench_kind = BENCH_SHARED; bench_kind <= BENCH_MUTEX; bench_kind++ )
+    {
+        for( int threads = 1; threads <= 64; threads *= 2 )
+        {
+            // hashed, so contain is a probe and not a scan in every setup
+            bench_list = bench_kind == BENCH_SHARED ? handy_create_shared_list( HANDY_LIST_HASHED )
+                                                    : handy_create_list_with( HANDY_LIST_HASHED );
+            for( int i = 0; i < bench_size; i++ )
+                handy_list_add_back( bench_list, (void *)(uintptr_t) i );
+            handy_list_index_refresh( bench_list );
+
+            pthread_t       workers[64];
+            struct timespec start, end;
+
+            atomic_store( &bench_stop, false );
+            atomic_store( &bench_ops, 0 );
+
+            clock_gettime( CLOCK_MONOTONIC, &start );
+            for( int i = 0; i < threads; i++ )
+                pthread_create( &workers[i], NULL, bench_worker, (void *)(uintptr_t) i );
+
+            struct timespec nap = { ms / 1000, ( ms % 1000 ) * 1000000L };
+            nanosleep( &nap, NULL );
+            atomic_store( &bench_stop, true );
+
+            for( int i = 0; i < threads; i++ )
+                pthread_join( workers[i], NULL );
+            clock_gettime( CLOCK_MONOTONIC, &end );
+
+            double seconds = ( end.tv_sec - start.tv_sec ) + ( end.tv_nsec - start.tv_nsec ) / 1e9;
+            long   ops = atomic_load( &bench_ops );
+
+            printf( "%s,%d,%d,%d,%ld,%.3f,%.2f\n", bench_names[ bench_kind ], threads,
+                    bench_size, bench_writes, ops, seconds, ops / seconds / 1e6 );
+            fflush( stdout );
+
+            handy_list_free( bench_list );
+            free( bench_list );
+        }
+    }
+    return 0;
+}
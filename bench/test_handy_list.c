@@ -0,0 +1,1462 @@
+// test_handy_list - behaviour of every handy_list variant against a plain
+// array, and of the operations built on node lists
+//
+//   cc -O2 -std=c11 -I.. test_handy_list.c ../handy_list.c
+//      ../handy_chunk_list.c ../handy_deque_list.c ../handy_small_list.c
+//      ../handy_shared_list.c ../handy_mapped_list.c ../handy_list_file.c
+//      ../handy_plist.c ../handy_queue.c ../handy_ilist.c ../handy_vec.c
+//      ../handy_tlist.c -o test_handy_list -lpthread
+//   ./test_handy_list [ steps ]
+//
+// Each variant runs steps ( default 20000 ) random add, rem, get, contain
+// and reverse calls side by side with an array that does the same, and
+// must agree with it after every call. Then sort, splice, split_at, concat,
+// add_back_n, the cursor, the hash index, the intrusive list, the vector
+// and its SIMD kernels, typed lists, reopening a mapped list, saving and
+// opening list files ( damaged ones too ), the persistent list and its
+// snapshots, the queue under two producers and two consumers, the shared
+// list read at both ends while used as a queue, and node pools freed from
+// other threads and trimmed are checked on their own, as are the operation
+// counters when built with -DHANDY_LIST_STATS.
+// Every failed check prints one line ( the refused mapped file makes the
+// library print its own error too ); the exit status is the number of
+// failures ( 0 when all pass ). A new variant is one more line in
+// test_variants.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../handy_list.h"
+#include "../handy_ilist.h"
+#include "../handy_vec.h"
+#include "../handy_tlist.h"
+#include "../handy_plist.h"
+#include "../handy_queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <unistd.h>
+
+static int          test_failed = 0;
+static int          test_checks = 0;
+static const char * test_name   = "";
+
+#define TEST_CHECK( cond )                                                          \
+    do                                                                              \
+    {                                                                               \
+        test_checks++;                                                              \
+        if( !( cond ) )                                                             \
+        {                                                                           \
+            test_failed++;                                                          \
+            printf( "FAIL %s:%d %s: %s\n", __FILE__, __LINE__, test_name, #cond );  \
+        }                                                                           \
+    } while( 0 )
+
+// items are small integers kept in the item word; 0 would read as "none"
+#define TEST_ITEM( n )  ( (void *)(uintptr_t)( n ) )
+#define TEST_VALUE( p ) ( (int)(uintptr_t)( p ) )
+
+static uint64_t test_seed = 88172645463325252ull;
+
+static int  test_random     ( int below )
+{
+    // xorshift64
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 7;
+    test_seed ^= test_seed << 17;
+    return below > 0 ? (int)( test_seed % (uint64_t) below ) : 0;
+}
+
+// variants
+
+static char test_mapped_path[64];
+
+static handy_list test_create_node      ()
+{
+    return handy_create_list();
+}
+static handy_list test_create_indexed   ()
+{
+    return handy_create_list_with( HANDY_LIST_INDEXED );
+}
+static handy_list test_create_hashed    ()
+{
+    return handy_create_list_with( HANDY_LIST_HASHED );
+}
+static handy_list test_create_small     ()
+{
+    return handy_create_small_list( 0 );
+}
+static handy_list test_create_shared    ()
+{
+    return handy_create_shared_list( HANDY_LIST_INDEXED | HANDY_LIST_HASHED );
+}
+static handy_list test_create_mapped    ()
+{
+    unlink( test_mapped_path );
+    return handy_create_mapped_list( test_mapped_path );
+}
+
+static const struct
+{
+    const char * name;
+    handy_list (*create)();
+} test_variants[] =
+{
+    { "node",    test_create_node },
+    { "indexed", test_create_indexed },
+    { "hashed",  test_create_hashed },
+    { "chunk",   handy_create_chunk_list },
+    { "deque",   handy_create_deque_list },
+    { "small",   test_create_small },
+    { "shared",  test_create_shared },
+    { "mapped",  test_create_mapped },
+};
+
+#define TEST_VARIANTS ( (int)( sizeof( test_variants ) / sizeof( test_variants[0] ) ) )
+
+// the array a list is checked against
+
+struct test_model
+{
+    int * items;
+    int   size;
+    int   capacity;
+};
+
+static void test_model_add_at   ( struct test_model * model, int item, int at )
+{
+    if( model->size == model->capacity )
+    {
+        model->capacity = model->capacity > 0 ? model->capacity * 2 : 64;
+        model->items = realloc( model->items, model->capacity * sizeof( int ) );
+    }
+    memmove( model->items + at + 1, model->items + at, ( model->size - at ) * sizeof( int ) );
+    model->items[at] = item;
+    model->size++;
+}
+static void test_model_rem_at   ( struct test_model * model, int at )
+{
+    memmove( model->items + at, model->items + at + 1, ( model->size - at - 1 ) * sizeof( int ) );
+    model->size--;
+}
+static int  test_model_contain  ( struct test_model * model, int item )
+{
+    for( int at = 0; at < model->size; at++ )
+    {
+        if( model->items[at] == item )
+            return at;
+    }
+    return -1;
+}
+static void test_model_reverse  ( struct test_model * model )
+{
+    for( int a = 0, b = model->size - 1; a < b; a++, b-- )
+    {
+        int item = model->items[a];
+
+        model->items[a] = model->items[b];
+        model->items[b] = item;
+    }
+}
+
+// whether list holds exactly the items of model, in order
+static bool test_same           ( handy_list list, struct test_model * model )
+{
+    if( handy_list_length( list ) != model->size )
+        return false;
+
+    for( int at = 0; at < model->size; at++ )
+    {
+        if( TEST_VALUE( handy_list_get_at( list, at ) ) != model->items[at] )
+            return false;
+    }
+    return true;
+}
+
+// list built from count items: first, first + 1, ..
+static handy_list test_build    ( handy_list list, int first, int count )
+{
+    for( int n = 0; n < count; n++ )
+        handy_list_add_back( list, TEST_ITEM( first + n ) );
+    return list;
+}
+
+static void test_release        ( handy_list list )
+{
+    handy_list_free( list );
+    free( list );
+}
+
+// every variant against the model
+
+static void test_variant        ( int variant, int steps )
+{
+    handy_list        list  = test_variants[ variant ].create();
+    struct test_model model = { NULL, 0, 0 };
+
+    test_name = test_variants[ variant ].name;
+    TEST_CHECK( list != NULL );
+    if( list == NULL )
+        return;
+
+    for( int step = 0; step < steps; step++ )
+    {
+        // values repeat, so contain meets duplicates; adds win slightly
+        // until the list holds 2000 items, then only removals run
+        int item = 1 + test_random( 500 );
+        int at   = test_random( model.size + 1 );
+        int op   = test_random( model.size > 2000 ? 6 : 11 );
+
+        switch( op )
+        {
+            case 0:
+            case 1:
+                TEST_CHECK( handy_list_rem_front( list ) == ( model.size > 0 ) );
+                if( model.size > 0 )
+                    test_model_rem_at( &model, 0 );
+                break;
+            case 2:
+                TEST_CHECK( handy_list_rem_back( list ) == ( model.size > 0 ) );
+                if( model.size > 0 )
+                    test_model_rem_at( &model, model.size - 1 );
+                break;
+            case 3:
+                TEST_CHECK( handy_list_rem_at( list, at ) == ( at < model.size ) );
+                if( at < model.size )
+                    test_model_rem_at( &model, at );
+                break;
+            case 4:
+                TEST_CHECK( handy_list_contain( list, TEST_ITEM( item ) ) == test_model_contain( &model, item ) );
+                break;
+            case 5:
+                if( at < model.size )
+                    TEST_CHECK( TEST_VALUE( handy_list_get_at( list, at ) ) == model.items[at] );
+                if( test_random( 50 ) == 0 )
+                {
+                    handy_list_reverse( list );
+                    test_model_reverse( &model );
+                }
+                break;
+            case 6:
+                TEST_CHECK( handy_list_add_front( list, TEST_ITEM( item ) ) );
+                test_model_add_at( &model, item, 0 );
+                break;
+            case 7:
+                TEST_CHECK( handy_list_add_at( list, TEST_ITEM( item ), at ) );
+                test_model_add_at( &model, item, at );
+                break;
+            default:
+                TEST_CHECK( handy_list_add_back( list, TEST_ITEM( item ) ) );
+                test_model_add_at( &model, item, model.size );
+                break;
+        }
+
+        TEST_CHECK( handy_list_length( list ) == model.size );
+        if( model.size > 0 )
+        {
+            TEST_CHECK( TEST_VALUE( handy_list_get_front( list ) ) == model.items[0] );
+            TEST_CHECK( TEST_VALUE( handy_list_get_back( list ) ) == model.items[ model.size - 1 ] );
+        }
+    }
+    TEST_CHECK( test_same( list, &model ) );
+
+    // a freed list is empty and can be used again, reading front to back
+    // even when it was reversed
+    handy_list_reverse( list );
+    handy_list_free( list );
+    TEST_CHECK( handy_list_empty( list ) && !list->_reversed );
+    TEST_CHECK( handy_list_add_back( list, TEST_ITEM( 1 ) ) && handy_list_add_back( list, TEST_ITEM( 2 ) ) );
+    TEST_CHECK( handy_list_length( list ) == 2 && TEST_VALUE( handy_list_get_front( list ) ) == 1 );
+
+    test_release( list );
+    free( model.items );
+}
+
+// operations on node lists
+
+static int  test_compare_keys   ( void * a, void * b, void * ctx )
+{
+    (void) ctx;
+    return TEST_VALUE( a ) / 1000 - TEST_VALUE( b ) / 1000;
+}
+
+static void test_sort           ()
+{
+    handy_list list = handy_create_list_with( HANDY_LIST_INDEXED );
+
+    test_name = "sort";
+
+    // n / 1000 is the key, which repeats, and n % 1000 the order items
+    // came in; a stable sort keeps that order among equal keys
+    for( int n = 0; n < 1000; n++ )
+        handy_list_add_back( list, TEST_ITEM( 1000 * ( 1 + test_random( 50 ) ) + n ) );
+
+    TEST_CHECK( handy_list_sort( list, test_compare_keys, NULL ) );
+    TEST_CHECK( handy_list_length( list ) == 1000 );
+
+    bool ordered = true;
+    for( int at = 1; at < 1000; at++ )
+    {
+        int before = TEST_VALUE( handy_list_get_at( list, at - 1 ) );
+        int after  = TEST_VALUE( handy_list_get_at( list, at ) );
+
+        ordered = ordered && ( before / 1000 < after / 1000 || ( before / 1000 == after / 1000 && before < after ) );
+    }
+    TEST_CHECK( ordered );
+
+    handy_list chunk = test_build( handy_create_chunk_list(), 1, 10 );
+    TEST_CHECK( !handy_list_sort( chunk, test_compare_keys, NULL ) );
+
+    test_release( chunk );
+    test_release( list );
+}
+
+static void test_bulk           ()
+{
+    struct test_model model = { NULL, 0, 0 };
+
+    test_name = "splice";
+    for( int flags = 0; flags < 4; flags++ )
+    {
+        // other indexed unlike self in half of the cases
+        handy_list list  = test_build( handy_create_list_with( flags ), 1, 10 );
+        handy_list other = test_build( handy_create_list_with( flags ^ ( flags >> 1 ) ), 100, 5 );
+
+        model.size = 0;
+        for( int n = 1; n <= 10; n++ )
+            test_model_add_at( &model, n, model.size );
+        for( int n = 0; n < 5; n++ )
+            test_model_add_at( &model, 100 + n, 3 + n );
+
+        TEST_CHECK( handy_list_splice( list, 3, other ) );
+        TEST_CHECK( handy_list_empty( other ) );
+        TEST_CHECK( test_same( list, &model ) );
+        TEST_CHECK( handy_list_contain( list, TEST_ITEM( 102 ) ) == 5 );
+        TEST_CHECK( handy_list_contain( list, TEST_ITEM( 10 ) ) == 14 );
+
+        test_name = "split_at";
+        handy_list tail = handy_list_split_at( list, 8 );
+        TEST_CHECK( tail != NULL );
+        if( tail != NULL )
+        {
+            TEST_CHECK( handy_list_length( list ) == 8 && handy_list_length( tail ) == 7 );
+            TEST_CHECK( TEST_VALUE( handy_list_get_front( tail ) ) == model.items[8] );
+            TEST_CHECK( handy_list_contain( tail, TEST_ITEM( 10 ) ) == 6 );
+            TEST_CHECK( handy_list_contain( list, TEST_ITEM( 10 ) ) == -1 );
+
+            test_name = "concat";
+            TEST_CHECK( handy_list_concat( list, tail ) );
+            TEST_CHECK( test_same( list, &model ) );
+            test_release( tail );
+        }
+
+        test_name = "add_back_n";
+        void * items[3000];
+        for( int n = 0; n < 3000; n++ )
+        {
+            items[n] = TEST_ITEM( 1000 + n );
+            test_model_add_at( &model, 1000 + n, model.size );
+        }
+        TEST_CHECK( handy_list_add_back_n( list, items, 3000 ) );
+        TEST_CHECK( test_same( list, &model ) );
+        TEST_CHECK( handy_list_contain( list, TEST_ITEM( 3999 ) ) == model.size - 1 );
+
+        test_release( other );
+        test_release( list );
+        test_name = "splice";
+    }
+
+    // a reversed list is cut at its physical front; at either end one half
+    // takes every node, and both halves must stay usable and freeable
+    test_name = "split_at reversed";
+    for( int flags = 0; flags < 4; flags++ )
+    {
+        int cuts[] = { -1, 0, 2, 5, 6 };
+
+        for( int c = 0; c < 5; c++ )
+        {
+            handy_list list = test_build( handy_create_list_with( flags ), 1, 5 );
+            int        kept = cuts[c] < 0 ? 0 : cuts[c] > 5 ? 5 : cuts[c];
+
+            handy_list_reverse( list );
+
+            handy_list tail = handy_list_split_at( list, cuts[c] );
+            TEST_CHECK( tail != NULL );
+            if( tail == NULL )
+            {
+                test_release( list );
+                continue;
+            }
+
+            // list read 5 4 3 2 1 before the cut
+            bool same = handy_list_length( list ) == kept && handy_list_length( tail ) == 5 - kept;
+            for( int at = 0; same && at < kept; at++ )
+                same = TEST_VALUE( handy_list_get_at( list, at ) ) == 5 - at;
+            for( int at = 0; same && at < 5 - kept; at++ )
+                same = TEST_VALUE( handy_list_get_at( tail, at ) ) == 5 - kept - at;
+            TEST_CHECK( same );
+            TEST_CHECK( handy_list_contain( tail, TEST_ITEM( 1 ) ) == ( kept < 5 ? 4 - kept : -1 ) );
+
+            // the tail is freed as the cut left it: an add would note its
+            // pool again
+            test_release( tail );
+
+            TEST_CHECK( handy_list_add_back( list, TEST_ITEM( 9 ) ) );
+            TEST_CHECK( TEST_VALUE( handy_list_get_back( list ) ) == 9 );
+            test_release( list );
+        }
+    }
+
+    // bulk moves are for node lists only and leave other kinds alone
+    handy_list list  = test_build( handy_create_list(), 1, 4 );
+    handy_list deque = test_build( handy_create_deque_list(), 1, 4 );
+    void *     item  = TEST_ITEM( 9 );
+
+    TEST_CHECK( !handy_list_splice( list, 0, deque ) && handy_list_length( deque ) == 4 );
+    TEST_CHECK( !handy_list_splice( deque, 0, list ) && handy_list_length( list ) == 4 );
+    TEST_CHECK( handy_list_split_at( deque, 2 ) == NULL && handy_list_length( deque ) == 4 );
+    TEST_CHECK( !handy_list_add_back_n( deque, &item, 1 ) && handy_list_length( deque ) == 4 );
+
+    test_release( deque );
+    test_release( list );
+    free( model.items );
+}
+
+static void test_cursor         ()
+{
+    handy_list        list = test_build( handy_create_list_with( HANDY_LIST_HASHED ), 1, 20 );
+    handy_list_cursor cursor;
+    int               seen = 0;
+
+    test_name = "cursor";
+
+    // drop the even items and put 100 + n before each odd n
+    handy_list_cursor_begin( list, &cursor );
+    while( handy_list_cursor_valid( &cursor ) )
+    {
+        int item = TEST_VALUE( handy_list_cursor_get( &cursor ) );
+
+        if( item % 2 == 0 )
+            TEST_CHECK( handy_list_cursor_erase( &cursor ) );
+        else
+        {
+            TEST_CHECK( handy_list_cursor_insert_before( &cursor, TEST_ITEM( 100 + item ) ) );
+            handy_list_cursor_next( &cursor );
+        }
+    }
+    TEST_CHECK( handy_list_length( list ) == 20 );
+    TEST_CHECK( handy_list_contain( list, TEST_ITEM( 119 ) ) == 18 );
+    TEST_CHECK( handy_list_contain( list, TEST_ITEM( 2 ) ) == -1 );
+
+    // back to front, on a reversed list
+    handy_list_reverse( list );
+    handy_list_cursor_end( list, &cursor );
+    for( int at = 0; handy_list_cursor_valid( &cursor ); handy_list_cursor_prev( &cursor ), at++ )
+    {
+        int expect = at % 2 == 0 ? 101 + at : at;
+
+        seen += TEST_VALUE( handy_list_cursor_get( &cursor ) ) == expect;
+    }
+    TEST_CHECK( seen == 20 );
+
+    test_release( list );
+}
+
+static void test_hash_index     ()
+{
+    struct test_model model = { NULL, 0, 0 };
+    handy_list        list  = handy_create_list_with( HANDY_LIST_HASHED );
+
+    test_name = "hash index";
+
+    // positions move under the index with every add_front and rem_at;
+    // contain must still find the first of equal items
+    for( int step = 0; step < 3000; step++ )
+    {
+        int item = 1 + test_random( 300 );
+
+        switch( test_random( 4 ) )
+        {
+            case 0:
+                handy_list_add_front( list, TEST_ITEM( item ) );
+                test_model_add_at( &model, item, 0 );
+                break;
+            case 1:
+                if( model.size > 0 )
+                {
+                    int at = test_random( model.size );
+
+                    handy_list_rem_at( list, at );
+                    test_model_rem_at( &model, at );
+                }
+                break;
+            case 2:
+                handy_list_add_back( list, TEST_ITEM( item ) );
+                test_model_add_at( &model, item, model.size );
+                break;
+            default:
+                TEST_CHECK( handy_list_contain( list, TEST_ITEM( item ) ) == test_model_contain( &model, item ) );
+                break;
+        }
+        if( step % 1000 == 999 )
+            handy_list_index_refresh( list );
+    }
+    TEST_CHECK( test_same( list, &model ) );
+    TEST_CHECK( handy_list_contain( list, TEST_ITEM( 1000 ) ) == -1 );
+    TEST_CHECK( handy_list_index_bytes( list ) > 0 );
+
+    test_release( list );
+    free( model.items );
+}
+
+static void test_small_spill     ()
+{
+    handy_list list = handy_create_small_list( HANDY_LIST_HASHED );
+
+    test_name = "small spill";
+
+    // the flags wait in the header until the list turns into a node list
+    TEST_CHECK( ( (uintptr_t) list & 63 ) == 0 );
+    test_build( list, 1, HANDY_SMALL_ITEMS );
+    TEST_CHECK( handy_list_index_bytes( list ) == 0 );
+    TEST_CHECK( handy_list_add_back( list, TEST_ITEM( HANDY_SMALL_ITEMS + 1 ) ) );
+    TEST_CHECK( list->_flags == HANDY_LIST_HASHED );
+    TEST_CHECK( handy_list_index_bytes( list ) > 0 );
+    TEST_CHECK( handy_list_contain( list, TEST_ITEM( HANDY_SMALL_ITEMS ) ) == HANDY_SMALL_ITEMS - 1 );
+
+    test_release( list );
+}
+
+// the intrusive list against the model; objects hold their own links
+
+#define TEST_OBJECTS 200
+
+struct test_object
+{
+    int                id;
+    bool               linked;
+    struct handy_ilink link;
+};
+
+static struct test_object test_objects[TEST_OBJECTS];
+
+static bool test_object_is      ( struct handy_ilink * link, void * id )
+{
+    return handy_ilist_entry( link, struct test_object, link )->id == TEST_VALUE( id );
+}
+
+// whether list links exactly the objects of model, in order, both ways
+static bool test_ilist_same     ( handy_ilist list, struct test_model * model )
+{
+    struct handy_ilink * iter = handy_ilist_get_front( list );
+
+    if( handy_ilist_length( list ) != model->size )
+        return false;
+
+    for( int at = 0; at < model->size; at++, iter = iter->_next )
+    {
+        if( iter == NULL || handy_ilist_entry( iter, struct test_object, link )->id != model->items[at] )
+            return false;
+    }
+    iter = handy_ilist_get_back( list );
+    for( int at = model->size - 1; at >= 0; at--, iter = iter->_prev )
+    {
+        if( handy_ilist_entry( iter, struct test_object, link )->id != model->items[at] )
+            return false;
+    }
+    return iter == NULL;
+}
+
+static void test_ilist          ()
+{
+    struct test_model model = { NULL, 0, 0 };
+    handy_ilist       list  = handy_create_ilist();
+
+    test_name = "ilist";
+
+    for( int n = 0; n < TEST_OBJECTS; n++ )
+        test_objects[n] = (struct test_object) { n + 1, false, { NULL, NULL } };
+
+    for( int step = 0; step < 20000; step++ )
+    {
+        struct test_object * object = &test_objects[ test_random( TEST_OBJECTS ) ];
+        int                  at     = test_random( model.size + 1 );
+
+        switch( test_random( 8 ) )
+        {
+            case 0:
+            case 1:
+                if( object->linked )
+                    break;
+                if( at == model.size )
+                    TEST_CHECK( handy_ilist_add_back( list, &object->link ) );
+                else if( at == 0 )
+                    TEST_CHECK( handy_ilist_add_front( list, &object->link ) );
+                else
+                    TEST_CHECK( handy_ilist_add_at( list, &object->link, at ) );
+                test_model_add_at( &model, object->id, at );
+                object->linked = true;
+                break;
+            case 2:
+                // before a linked object, or at the end
+                if( object->linked )
+                    break;
+                struct handy_ilink * before = at < model.size ? &test_objects[ model.items[at] - 1 ].link : NULL;
+                TEST_CHECK( handy_ilist_add_before( list, &object->link, before ) );
+                test_model_add_at( &model, object->id, at );
+                object->linked = true;
+                break;
+            case 3:
+                if( !object->linked )
+                    break;
+                at = test_model_contain( &model, object->id );
+                TEST_CHECK( handy_ilist_contain( list, &object->link ) == at );
+                handy_ilist_rem( list, &object->link );
+                test_model_rem_at( &model, at );
+                object->linked = false;
+                break;
+            case 4:
+                if( model.size == 0 )
+                {
+                    TEST_CHECK( !handy_ilist_rem_front( list ) && !handy_ilist_rem_back( list ) );
+                    break;
+                }
+                at = test_random( 3 ) == 0 ? 0 : test_random( 2 ) == 0 ? model.size - 1 : test_random( model.size );
+                test_objects[ model.items[at] - 1 ].linked = false;
+                if( at == 0 )
+                    TEST_CHECK( handy_ilist_rem_front( list ) );
+                else if( at == model.size - 1 )
+                    TEST_CHECK( handy_ilist_rem_back( list ) );
+                else
+                    TEST_CHECK( handy_ilist_rem_at( list, at ) );
+                test_model_rem_at( &model, at );
+                break;
+            case 5:
+                if( at < model.size )
+                    TEST_CHECK( handy_ilist_get_at( list, at ) == &test_objects[ model.items[at] - 1 ].link );
+                else
+                    TEST_CHECK( handy_ilist_get_at( list, at ) == NULL );
+                break;
+            case 6:
+                TEST_CHECK( handy_ilist_find( list, test_object_is, TEST_ITEM( object->id ) ) == test_model_contain( &model, object->id ) );
+                break;
+            default:
+                if( test_random( 10 ) == 0 )
+                {
+                    handy_ilist_reverse( list );
+                    test_model_reverse( &model );
+                }
+                break;
+        }
+        if( step % 97 == 0 && !test_ilist_same( list, &model ) )
+        {
+            TEST_CHECK( test_ilist_same( list, &model ) );
+            break;
+        }
+    }
+    TEST_CHECK( test_ilist_same( list, &model ) );
+    TEST_CHECK( handy_ilist_empty( list ) == ( model.size == 0 ) );
+
+    // cleared, every object is free to join another list
+    handy_ilist_clear( list );
+    TEST_CHECK( handy_ilist_empty( list ) && handy_ilist_get_front( list ) == NULL && handy_ilist_get_back( list ) == NULL );
+    for( int n = 0; n < TEST_OBJECTS; n++ )
+    {
+        if( test_objects[n].linked )
+            TEST_CHECK( test_objects[n].link._next == NULL && test_objects[n].link._prev == NULL );
+    }
+
+    free( list );
+    free( model.items );
+}
+
+// the vector's SIMD kernels against plain loops, at every length up to a
+// few vectors and every start within one, so every tail is covered
+
+#define TEST_VEC_ITEMS 160
+
+static void test_vec_kernels    ()
+{
+    int32_t  small[ TEST_VEC_ITEMS ];
+    int64_t  wide[ TEST_VEC_ITEMS ];
+    uint64_t mask[ ( TEST_VEC_ITEMS + 63 ) / 64 ];
+
+    test_name = "vec kernels";
+
+    for( int round = 0; round < 4; round++ )
+    {
+        // few distinct values, negative ones too, so items repeat
+        for( int i = 0; i < TEST_VEC_ITEMS; i++ )
+        {
+            small[i] = test_random( 9 ) - 4;
+            wide[i] = round % 2 == 0 ? small[i] : small[i] * ( (int64_t) 1 << 33 ) + ( small[i] & 1 );
+        }
+
+        for( int from = 0; from < 8; from++ )
+        {
+            for( int count = 0; from + count <= TEST_VEC_ITEMS; count++ )
+            {
+                const int32_t * items = small + from;
+                const int64_t * longs = wide + from;
+                size_t          even  = 0;
+                size_t          long_even = 0;
+
+                for( int i = 0; i < count; i++ )
+                {
+                    even += ( items[i] & 1 ) == 0;
+                    long_even += ( longs[i] & 1 ) == 0;
+                }
+                TEST_CHECK( handy_i32_count_even( items, count ) == even );
+                TEST_CHECK( handy_i64_count_even( longs, count ) == long_even );
+
+                // bits past count must come back cleared
+                memset( mask, 0xff, sizeof( mask ) );
+                handy_i32_even_mask( items, count, mask );
+                for( int i = 0; i < ( count + 63 ) / 64 * 64; i++ )
+                    TEST_CHECK( ( ( mask[i / 64] >> ( i % 64 ) ) & 1 ) == ( i < count && ( items[i] & 1 ) == 0 ) );
+
+                for( int probe = -5; probe <= 5; probe++ )
+                {
+                    int64_t long_probe = round % 2 == 0 ? probe : probe * ( (int64_t) 1 << 33 ) + ( probe & 1 );
+                    long    first = -1, long_first = -1;
+                    size_t  hits = 0, long_hits = 0;
+
+                    for( int i = count - 1; i >= 0; i-- )
+                    {
+                        if( items[i] == probe )
+                        {
+                            first = i;
+                            hits++;
+                        }
+                        if( longs[i] == long_probe )
+                        {
+                            long_first = i;
+                            long_hits++;
+                        }
+                    }
+                    TEST_CHECK( handy_i32_find( items, count, probe ) == first );
+                    TEST_CHECK( handy_i32_count( items, count, probe ) == hits );
+                    TEST_CHECK( handy_i64_find( longs, count, long_probe ) == long_first );
+                    TEST_CHECK( handy_i64_count( longs, count, long_probe ) == long_hits );
+                }
+            }
+        }
+    }
+}
+
+// the vector against the model: both ends grow and shrink
+static void test_vec            ()
+{
+    struct test_model model = { NULL, 0, 0 };
+    handy_vec_i32     vec   = handy_create_vec_i32();
+    int32_t           item;
+
+    test_name = "vec";
+
+    for( int step = 0; step < 20000; step++ )
+    {
+        int value = 1 + test_random( 50 );
+
+        switch( test_random( 6 ) )
+        {
+            case 0:
+                TEST_CHECK( handy_vec_i32_push_back( vec, value ) );
+                test_model_add_at( &model, value, model.size );
+                break;
+            case 1:
+                TEST_CHECK( handy_vec_i32_push_front( vec, value ) );
+                test_model_add_at( &model, value, 0 );
+                break;
+            case 2:
+                TEST_CHECK( handy_vec_i32_pop_back( vec, &item ) == ( model.size > 0 ) );
+                if( model.size > 0 )
+                {
+                    TEST_CHECK( item == model.items[ model.size - 1 ] );
+                    test_model_rem_at( &model, model.size - 1 );
+                }
+                break;
+            case 3:
+                TEST_CHECK( handy_vec_i32_pop_front( vec, &item ) == ( model.size > 0 ) );
+                if( model.size > 0 )
+                {
+                    TEST_CHECK( item == model.items[0] );
+                    test_model_rem_at( &model, 0 );
+                }
+                break;
+            case 4:
+            {
+                int32_t values[70];
+                int     count = test_random( 70 );
+
+                for( int i = 0; i < count; i++ )
+                {
+                    values[i] = 1 + test_random( 50 );
+                    test_model_add_at( &model, values[i], model.size );
+                }
+                TEST_CHECK( handy_vec_i32_push_back_n( vec, values, count ) );
+                break;
+            }
+            default:
+                TEST_CHECK( handy_vec_i32_find( vec, value ) == test_model_contain( &model, value ) );
+                TEST_CHECK( handy_vec_i32_contain( vec, value ) == ( test_model_contain( &model, value ) >= 0 ) );
+                break;
+        }
+    }
+
+    TEST_CHECK( handy_vec_i32_length( vec ) == (size_t) model.size );
+    TEST_CHECK( memcmp( handy_vec_i32_data( vec ), model.items, model.size * sizeof( int ) ) == 0 );
+
+    handy_vec_i32_clear( vec );
+    TEST_CHECK( handy_vec_i32_empty( vec ) && handy_vec_i32_find( vec, 1 ) == -1 );
+
+    handy_vec_i32_free( vec );
+    free( vec );
+    free( model.items );
+}
+
+// typed lists: values, zero and negative ones too, live in the nodes
+
+HANDY_LIST_DECLARE( float, float )
+HANDY_LIST_DEFINE( float, float )
+
+// equal when the last digits are
+static int  test_compare_digit  ( int a, int b )
+{
+    return ( a % 10 + 10 ) % 10 - ( b % 10 + 10 ) % 10;
+}
+
+static void test_tlist          ()
+{
+    struct test_model model = { NULL, 0, 0 };
+    handy_list_int    list  = handy_create_list_int( NULL );
+    int               out[ 70 ];
+    int               item;
+
+    test_name = "tlist";
+
+    for( int step = 0; step < 20000; step++ )
+    {
+        int value = test_random( 41 ) - 20;
+        int at    = test_random( model.size + 1 );
+
+        switch( test_random( 7 ) )
+        {
+            case 0:
+                TEST_CHECK( handy_list_int_add_front( list, value ) );
+                test_model_add_at( &model, value, 0 );
+                break;
+            case 1:
+                TEST_CHECK( handy_list_int_add_at( list, value, at ) );
+                test_model_add_at( &model, value, at );
+                break;
+            case 2:
+            {
+                int values[ 70 ];
+                int count = test_random( 70 );
+
+                for( int i = 0; i < count; i++ )
+                {
+                    values[i] = test_random( 41 ) - 20;
+                    test_model_add_at( &model, values[i], model.size );
+                }
+                TEST_CHECK( handy_list_int_add_back_n( list, values, count ) );
+                break;
+            }
+            case 3:
+                if( model.size == 0 )
+                {
+                    TEST_CHECK( !handy_list_int_rem_back( list ) && !handy_list_int_get_front( list, &item ) );
+                    break;
+                }
+                at = test_random( model.size );
+                TEST_CHECK( handy_list_int_rem_at( list, at ) );
+                test_model_rem_at( &model, at );
+                break;
+            case 4:
+                item = 99;
+                TEST_CHECK( handy_list_int_get_at( list, at, &item ) == ( at < model.size ) );
+                TEST_CHECK( item == ( at < model.size ? model.items[at] : 99 ) );
+                break;
+            case 5:
+            {
+                int count = test_random( 70 );
+                int got   = handy_list_int_tail( list, out, count );
+
+                TEST_CHECK( got == ( count < model.size ? count : model.size ) );
+                TEST_CHECK( memcmp( out, model.items + model.size - got, got * sizeof( int ) ) == 0 );
+                TEST_CHECK( handy_list_int_contain( list, value ) == test_model_contain( &model, value ) );
+                break;
+            }
+            default:
+                if( test_random( 20 ) == 0 )
+                {
+                    handy_list_int_reverse( list );
+                    test_model_reverse( &model );
+                }
+                else if( model.size > 0 )
+                {
+                    TEST_CHECK( handy_list_int_get_front( list, &item ) && item == model.items[0] );
+                    TEST_CHECK( handy_list_int_get_back( list, &item ) && item == model.items[ model.size - 1 ] );
+                }
+                break;
+        }
+    }
+    TEST_CHECK( handy_list_int_length( list ) == model.size );
+    TEST_CHECK( handy_list_int_tail( list, out, 70 ) == ( model.size < 70 ? model.size : 70 ) );
+
+    handy_list_int_free( list );
+    free( list );
+    free( model.items );
+
+    // contain goes through the comparator when there is one
+    list = handy_create_list_int( test_compare_digit );
+    for( int n = 1; n <= 30; n++ )
+        handy_list_int_add_back( list, n );
+    TEST_CHECK( handy_list_int_contain( list, 47 ) == 6 && handy_list_int_contain( list, -3 ) == 6 );
+    handy_list_int_free( list );
+    free( list );
+
+    // another type from the same generator
+    handy_list_float floats = handy_create_list_float( NULL );
+    float            value;
+
+    for( int n = 0; n < 100; n++ )
+        handy_list_float_add_back( floats, n * 0.5f - 10.0f );
+    TEST_CHECK( handy_list_float_get_at( floats, 21, &value ) && value == 0.5f );
+    TEST_CHECK( handy_list_float_contain( floats, 0.0f ) == 20 && handy_list_float_contain( floats, 0.25f ) == -1 );
+    handy_list_float_free( floats );
+    free( floats );
+}
+
+// the operation counters: built with HANDY_LIST_STATS every call and every
+// node walked is counted, per list and summed over all lists
+
+static void test_stats          ()
+{
+    struct handy_list_stats stats, before, after;
+    handy_list              list = handy_create_list();
+
+    test_name = "stats";
+
+#ifdef HANDY_LIST_STATS
+    TEST_CHECK( handy_list_stats( NULL, &before ) );
+
+    test_build( list, 1, 10 );
+    handy_list_add_front( list, TEST_ITEM( 99 ) );
+    handy_list_stats( list, &stats );
+    TEST_CHECK( stats.ops[ HANDY_OP_ADD_BACK ] == 10 && stats.ops[ HANDY_OP_ADD_FRONT ] == 1 );
+    TEST_CHECK( stats.allocs == 11 && stats.peak_size == 11 && stats.hops == 0 );
+
+    // get_at walks from the nearer end, contain from the front
+    handy_list_get_at( list, 5 );
+    TEST_CHECK( handy_list_stats( list, &stats ) && stats.hops == 5 );
+    handy_list_contain( list, TEST_ITEM( 7 ) );
+    handy_list_contain( list, TEST_ITEM( 50 ) );
+    handy_list_stats( list, &stats );
+    TEST_CHECK( stats.ops[ HANDY_OP_GET_AT ] == 1 && stats.ops[ HANDY_OP_CONTAIN ] == 2 );
+    TEST_CHECK( stats.hops == 5 + 7 + 11 );
+
+    handy_list_rem_front( list );
+    handy_list_rem_back( list );
+    handy_list_rem_at( list, 3 );
+    handy_list_reverse( list );
+    handy_list_stats( list, &stats );
+    TEST_CHECK( stats.ops[ HANDY_OP_REM_FRONT ] == 1 && stats.ops[ HANDY_OP_REM_BACK ] == 1 );
+    TEST_CHECK( stats.ops[ HANDY_OP_REM_AT ] == 1 && stats.ops[ HANDY_OP_REVERSE ] == 1 );
+    TEST_CHECK( stats.frees == 3 && stats.peak_size == 11 );
+
+    // the rest go with free, and the sums over all lists saw the same
+    handy_list_free( list );
+    handy_list_stats( list, &stats );
+    handy_list_stats( NULL, &after );
+    TEST_CHECK( stats.ops[ HANDY_OP_FREE ] == 1 && stats.frees == stats.allocs );
+    for( int op = 0; op < HANDY_OP_COUNT; op++ )
+        TEST_CHECK( after.ops[op] - before.ops[op] == stats.ops[op] );
+    TEST_CHECK( after.hops - before.hops == stats.hops && after.allocs - before.allocs == stats.allocs );
+    TEST_CHECK( after.peak_size >= stats.peak_size );
+#else
+    // nothing is counted, and the readout says so
+    test_build( list, 1, 10 );
+    handy_list_free( list );
+    TEST_CHECK( handy_list_stats( list, &stats ) == false && stats.allocs == 0 && stats.ops[ HANDY_OP_ADD_BACK ] == 0 );
+    (void) before;
+    (void) after;
+#endif
+    free( list );
+}
+
+static void test_mapped_reopen  ()
+{
+    handy_list list = test_create_mapped();
+
+    test_name = "mapped reopen";
+    TEST_CHECK( list != NULL );
+    if( list == NULL )
+        return;
+
+    test_build( list, 1, 1000 );
+    handy_list_rem_front( list );
+    TEST_CHECK( handy_list_checkpoint( list ) );
+    test_release( list );
+
+    list = handy_create_mapped_list( test_mapped_path );
+    TEST_CHECK( list != NULL );
+    if( list == NULL )
+        return;
+
+    TEST_CHECK( handy_list_length( list ) == 999 );
+    TEST_CHECK( TEST_VALUE( handy_list_get_front( list ) ) == 2 );
+    TEST_CHECK( TEST_VALUE( handy_list_get_back( list ) ) == 1000 );
+    TEST_CHECK( handy_list_contain( list, TEST_ITEM( 500 ) ) == 498 );
+
+    test_release( list );
+    unlink( test_mapped_path );
+
+    // a file that is not a mapped list is refused
+    FILE * junk = fopen( test_mapped_path, "w" );
+    if( junk != NULL )
+    {
+        fputs( "not a list", junk );
+        fclose( junk );
+        TEST_CHECK( handy_create_mapped_list( test_mapped_path ) == NULL );
+        unlink( test_mapped_path );
+    }
+}
+
+// the persistent list against the model, with snapshots kept along the
+// way that must not change while later versions are made from them
+
+#define TEST_PLIST_SNAPS 8
+
+static bool test_plist_same     ( handy_plist list, struct test_model * model )
+{
+    bool same = handy_plist_length( list ) == model->size;
+
+    if( same && model->size > 0 )
+        same = TEST_VALUE( handy_plist_get_front( list ) ) == model->items[0] &&
+               TEST_VALUE( handy_plist_get_back( list ) ) == model->items[ model->size - 1 ];
+
+    for( int at = 0; same && at < model->size; at++ )
+        same = TEST_VALUE( handy_plist_get_at( list, at ) ) == model->items[at];
+    return same;
+}
+
+static void test_plist          ()
+{
+    struct test_model model = { NULL, 0, 0 };
+    struct test_model kept[ TEST_PLIST_SNAPS ];
+    handy_plist       snaps[ TEST_PLIST_SNAPS ];
+    handy_plist       list = handy_create_plist();
+    int               taken = 0;
+
+    test_name = "plist";
+    for( int step = 0; step < 4000; step++ )
+    {
+        handy_plist next;
+        int         item = 1 + test_random( 500 );
+
+        switch( test_random( model.size > 300 ? 4 : 5 ) )
+        {
+            case 0:
+                next = handy_plist_rem_front( list );
+                TEST_CHECK( ( next != NULL ) == ( model.size > 0 ) );
+                if( model.size > 0 )
+                    test_model_rem_at( &model, 0 );
+                break;
+            case 1:
+                next = handy_plist_rem_back( list );
+                TEST_CHECK( ( next != NULL ) == ( model.size > 0 ) );
+                if( model.size > 0 )
+                    test_model_rem_at( &model, model.size - 1 );
+                break;
+            case 2:
+                next = handy_plist_add_front( list, TEST_ITEM( item ) );
+                test_model_add_at( &model, item, 0 );
+                break;
+            default:
+                next = handy_plist_add_back( list, TEST_ITEM( item ) );
+                test_model_add_at( &model, item, model.size );
+                break;
+        }
+        if( next == NULL )
+            continue;
+
+        handy_plist_release( list );
+        list = next;
+        TEST_CHECK( test_plist_same( list, &model ) );
+
+        if( step % 500 == 0 && taken < TEST_PLIST_SNAPS )
+        {
+            snaps[ taken ] = handy_plist_retain( list );
+            kept[ taken ].items = malloc( ( model.size + 1 ) * sizeof( int ) );
+            kept[ taken ].size = kept[ taken ].capacity = model.size;
+            memcpy( kept[ taken ].items, model.items, model.size * sizeof( int ) );
+            taken++;
+        }
+    }
+
+    for( int k = 0; k < taken; k++ )
+    {
+        TEST_CHECK( test_plist_same( snaps[k], &kept[k] ) );
+        if( kept[k].size > 0 )
+            TEST_CHECK( handy_plist_contain( snaps[k], TEST_ITEM( kept[k].items[ kept[k].size - 1 ] ) ) ==
+                        test_model_contain( &kept[k], kept[k].items[ kept[k].size - 1 ] ) );
+        handy_plist_release( snaps[k] );
+        free( kept[k].items );
+    }
+    handy_plist_release( list );
+
+    // one item at the front and many at the back, then removals that run
+    // an end out again and again: each rebuild must leave half behind, or
+    // this takes quadratic time
+    list = handy_create_plist();
+    for( int n = 0; n <= 100000; n++ )
+    {
+        handy_plist next = n == 0 ? handy_plist_add_front( list, TEST_ITEM( 1 ) )
+                                  : handy_plist_add_back( list, TEST_ITEM( n + 1 ) );
+        handy_plist_release( list );
+        list = next;
+    }
+    for( int n = 0; n < 50000 && list != NULL; n++ )
+    {
+        handy_plist next = n % 2 == 0 ? handy_plist_rem_front( list ) : handy_plist_rem_back( list );
+        handy_plist_release( list );
+        list = next;
+    }
+    TEST_CHECK( list != NULL && handy_plist_length( list ) == 50001 );
+    if( list != NULL )
+    {
+        TEST_CHECK( TEST_VALUE( handy_plist_get_front( list ) ) == 25001 );
+        TEST_CHECK( TEST_VALUE( handy_plist_get_back( list ) ) == 75001 );
+        handy_plist_release( list );
+    }
+    free( model.items );
+}
+
+// save and open: scalar and record files, and records whose stored
+// extent was damaged after the save
+
+static size_t test_string_size  ( void * item, void * ctx )
+{
+    (void) ctx;
+    return strlen( item ) + 1;
+}
+static void test_string_write   ( void * item, void * out, void * ctx )
+{
+    (void) ctx;
+    strcpy( out, item );
+}
+
+// overwrite record offset at in a saved file; the table follows the
+// 24-byte header
+static void test_file_offset    ( const char * path, int at, uint64_t offset )
+{
+    FILE * file = fopen( path, "r+b" );
+
+    if( file != NULL )
+    {
+        fseek( file, 24 + at * (long) sizeof( offset ), SEEK_SET );
+        fwrite( &offset, sizeof( offset ), 1, file );
+        fclose( file );
+    }
+}
+
+static void test_file_dump      ()
+{
+    struct handy_list_codec strings = { test_string_size, test_string_write, NULL };
+    handy_list              list = test_build( handy_create_deque_list(), 1, 100 );
+    handy_list              view;
+
+    test_name = "save scalar";
+    TEST_CHECK( handy_list_save( list, test_mapped_path, NULL ) );
+    view = handy_list_open( test_mapped_path );
+    TEST_CHECK( view != NULL );
+    if( view != NULL )
+    {
+        TEST_CHECK( handy_list_length( view ) == 100 );
+        TEST_CHECK( TEST_VALUE( handy_list_get_at( view, 99 ) ) == 100 );
+        TEST_CHECK( !handy_list_add_back( view, TEST_ITEM( 1 ) ) && !handy_list_rem_front( view ) );
+        handy_list_reverse( view );
+        TEST_CHECK( TEST_VALUE( handy_list_get_front( view ) ) == 100 );
+        test_release( view );
+    }
+    test_release( list );
+
+    test_name = "save records";
+    list = handy_create_list();
+    handy_list_add_back( list, "alpha" );
+    handy_list_add_back( list, "be" );
+    handy_list_add_back( list, "gamma, delta" );
+
+    TEST_CHECK( handy_list_save( list, test_mapped_path, &strings ) );
+    view = handy_list_open( test_mapped_path );
+    TEST_CHECK( view != NULL );
+    if( view != NULL )
+    {
+        TEST_CHECK( handy_list_length( view ) == 3 );
+        TEST_CHECK( strcmp( handy_list_get_at( view, 1 ), "be" ) == 0 );
+        TEST_CHECK( strcmp( handy_list_get_back( view ), "gamma, delta" ) == 0 );
+        TEST_CHECK( (uintptr_t) handy_list_get_at( view, 2 ) % 8 == 0 );
+        test_release( view );
+    }
+
+    // record 1 made to end past the file: it and the record after it,
+    // which starts there, read as NULL; record 0 is untouched
+    test_file_offset( test_mapped_path, 2, 1 << 20 );
+    view = handy_list_open( test_mapped_path );
+    TEST_CHECK( view != NULL );
+    if( view != NULL )
+    {
+        TEST_CHECK( strcmp( handy_list_get_at( view, 0 ), "alpha" ) == 0 );
+        TEST_CHECK( handy_list_get_at( view, 1 ) == NULL && handy_list_get_at( view, 2 ) == NULL );
+        test_release( view );
+    }
+
+    // record 0 made to start inside the offset table
+    test_file_offset( test_mapped_path, 0, 8 );
+    view = handy_list_open( test_mapped_path );
+    TEST_CHECK( view != NULL && handy_list_get_at( view, 0 ) == NULL );
+    if( view != NULL )
+        test_release( view );
+
+    // a file cut short keeps the records that still fit
+    TEST_CHECK( handy_list_save( list, test_mapped_path, &strings ) );
+    TEST_CHECK( truncate( test_mapped_path, 24 + 4 * 8 + 8 ) == 0 );
+    view = handy_list_open( test_mapped_path );
+    TEST_CHECK( view != NULL );
+    if( view != NULL )
+    {
+        TEST_CHECK( strcmp( handy_list_get_at( view, 0 ), "alpha" ) == 0 );
+        TEST_CHECK( handy_list_get_at( view, 1 ) == NULL && handy_list_get_at( view, 2 ) == NULL );
+        test_release( view );
+    }
+
+    test_release( list );
+    unlink( test_mapped_path );
+}
+
+// the queue: every item produced is consumed exactly once
+
+#define TEST_QUEUE_ITEMS 100000
+
+static handy_queue  test_queue;
+static _Atomic long test_queue_sum;
+static _Atomic long test_queue_taken;
+
+static void * test_produce      ( void * first )
+{
+    for( int n = 0; n < TEST_QUEUE_ITEMS; n++ )
+    {
+        while( !handy_queue_add_back( test_queue, TEST_ITEM( TEST_VALUE( first ) + n ) ) )
+            ;
+    }
+    return NULL;
+}
+static void * test_consume      ( void * unused )
+{
+    void * item;
+
+    while( test_queue_taken < 2 * TEST_QUEUE_ITEMS )
+    {
+        if( handy_queue_pop_front( test_queue, &item ) )
+        {
+            test_queue_sum += TEST_VALUE( item );
+            test_queue_taken++;
+        }
+    }
+    return unused;
+}
+
+static void test_queue_threads  ()
+{
+    pthread_t threads[4];
+
+    test_name = "queue";
+    test_queue = handy_create_queue();
+    TEST_CHECK( test_queue != NULL && handy_queue_empty( test_queue ) );
+    if( test_queue == NULL )
+        return;
+
+    pthread_create( &threads[0], NULL, test_produce, TEST_ITEM( 1 ) );
+    pthread_create( &threads[1], NULL, test_produce, TEST_ITEM( 1 + TEST_QUEUE_ITEMS ) );
+    pthread_create( &threads[2], NULL, test_consume, NULL );
+    pthread_create( &threads[3], NULL, test_consume, NULL );
+    for( int t = 0; t < 4; t++ )
+        pthread_join( threads[t], NULL );
+
+    // 1 .. 2 * TEST_QUEUE_ITEMS
+    long expect = (long) TEST_QUEUE_ITEMS * ( 2 * TEST_QUEUE_ITEMS + 1 );
+
+    TEST_CHECK( test_queue_taken == 2 * TEST_QUEUE_ITEMS );
+    TEST_CHECK( test_queue_sum == expect );
+    TEST_CHECK( handy_queue_empty( test_queue ) && handy_queue_length( test_queue ) == 0 );
+
+    handy_queue_free( test_queue );
+}
+
+// the shared list as a queue: one thread adds at the back, one removes at
+// the front, and readers at both ends and in the middle must never see a
+// torn list. It holds from TEST_SHARED_FLOOR to four times as many items
+
+#define TEST_SHARED_ITEMS 20000
+#define TEST_SHARED_FLOOR 64
+
+static handy_list   test_shared;
+static _Atomic bool test_shared_done;
+static _Atomic long test_shared_bad;
+
+static void * test_shared_produce   ( void * unused )
+{
+    for( int n = TEST_SHARED_FLOOR + 1; n <= TEST_SHARED_ITEMS; n++ )
+    {
+        while( handy_list_length( test_shared ) >= 4 * TEST_SHARED_FLOOR )
+            sched_yield();
+        handy_list_add_back( test_shared, TEST_ITEM( n ) );
+    }
+    return unused;
+}
+static void * test_shared_consume   ( void * unused )
+{
+    while( !test_shared_done )
+    {
+        if( handy_list_length( test_shared ) > TEST_SHARED_FLOOR )
+            handy_list_rem_front( test_shared );
+    }
+    return unused;
+}
+static void * test_shared_read      ( void * unused )
+{
+    while( !test_shared_done )
+    {
+        int front = TEST_VALUE( handy_list_get_front( test_shared ) );
+        int back  = TEST_VALUE( handy_list_get_back( test_shared ) );
+        int at    = TEST_VALUE( handy_list_get_at( test_shared, TEST_SHARED_FLOOR - 1 ) );
+
+        // each read on its own: the queue only moves forward
+        if( front < 1 || back < front || at < front || at > TEST_SHARED_ITEMS )
+            test_shared_bad++;
+        if( handy_list_contain( test_shared, TEST_ITEM( TEST_SHARED_ITEMS + 1 ) ) != -1 )
+            test_shared_bad++;
+    }
+    return unused;
+}
+
+static void test_shared_threads     ()
+{
+    pthread_t threads[5];
+
+    test_name = "shared threads";
+    test_shared = test_build( handy_create_shared_list( 0 ), 1, TEST_SHARED_FLOOR );
+
+    pthread_create( &threads[0], NULL, test_shared_consume, NULL );
+    for( int t = 1; t < 4; t++ )
+        pthread_create( &threads[t], NULL, test_shared_read, NULL );
+    pthread_create( &threads[4], NULL, test_shared_produce, NULL );
+
+    pthread_join( threads[4], NULL );
+    while( handy_list_length( test_shared ) > TEST_SHARED_FLOOR )
+        sched_yield();
+    test_shared_done = true;
+    for( int t = 0; t < 4; t++ )
+        pthread_join( threads[t], NULL );
+
+    TEST_CHECK( test_shared_bad == 0 );
+    TEST_CHECK( handy_list_length( test_shared ) == TEST_SHARED_FLOOR );
+    for( int at = 0; at < TEST_SHARED_FLOOR; at++ )
+        TEST_CHECK( TEST_VALUE( handy_list_get_at( test_shared, at ) ) == TEST_SHARED_ITEMS - TEST_SHARED_FLOOR + 1 + at );
+
+    test_release( test_shared );
+}
+
+// the node pool: frees on another thread go back to the pool that made
+// the nodes, and a pool gives its slabs back only once nothing is out
+
+#define TEST_POOL_ITEMS 10000
+
+static void * test_pool_free    ( void * list )
+{
+    test_release( list );
+    return NULL;
+}
+static void * test_pool_build   ( void * out )
+{
+    *(handy_list *) out = test_build( handy_create_list(), 1, TEST_POOL_ITEMS );
+    return NULL;
+}
+static void * test_pool_owner   ( void * unused )
+{
+    struct handy_list_pool_stats stats;
+    handy_list                   list = test_build( handy_create_list(), 1, TEST_POOL_ITEMS );
+    pthread_t                    other;
+
+    // a fresh thread: its pool holds this list and nothing else
+    handy_list_pool_stats( &stats );
+    TEST_CHECK( stats.node_allocs == TEST_POOL_ITEMS && stats.live_nodes == TEST_POOL_ITEMS );
+    TEST_CHECK( stats.slab_mallocs > 0 && stats.slab_mallocs < TEST_POOL_ITEMS / 100 );
+    TEST_CHECK( stats.mallocs_avoided == stats.node_allocs - stats.slab_mallocs );
+    TEST_CHECK( handy_list_pool_trim() == false );
+
+    pthread_create( &other, NULL, test_pool_free, list );
+    pthread_join( other, NULL );
+
+    handy_list_pool_stats( &stats );
+    TEST_CHECK( stats.node_frees == TEST_POOL_ITEMS && stats.live_nodes == 0 );
+    TEST_CHECK( handy_list_pool_trim() == true );
+
+    // the pool serves again after a trim, from a new slab
+    list = test_build( handy_create_list(), 1, 100 );
+    handy_list_pool_stats( &stats );
+    TEST_CHECK( handy_list_length( list ) == 100 && stats.live_nodes == 100 );
+    test_release( list );
+    return unused;
+}
+
+static void test_pool_threads   ()
+{
+    handy_list list = NULL;
+    pthread_t  thread;
+
+    test_name = "pool";
+
+    pthread_create( &thread, NULL, test_pool_owner, NULL );
+    pthread_join( thread, NULL );
+
+    // the thread that made the nodes is gone before they are freed; its
+    // pool goes with the last of them
+    pthread_create( &thread, NULL, test_pool_build, &list );
+    pthread_join( thread, NULL );
+    TEST_CHECK( list != NULL && handy_list_length( list ) == TEST_POOL_ITEMS );
+    TEST_CHECK( TEST_VALUE( handy_list_get_back( list ) ) == TEST_POOL_ITEMS );
+    test_release( list );
+}
+
+int main( int argc, char ** argv )
+{
+    int steps = argc > 1 ? atoi( argv[1] ) : 20000;
+
+    snprintf( test_mapped_path, sizeof( test_mapped_path ), "/tmp/test_handy_list.%ld", (long) getpid() );
+
+    for( int variant = 0; variant < TEST_VARIANTS; variant++ )
+        test_variant( variant, steps );
+
+    test_sort();
+    test_bulk();
+    test_cursor();
+    test_hash_index();
+    test_small_spill();
+    test_ilist();
+    test_vec_kernels();
+    test_vec();
+    test_tlist();
+    test_stats();
+    test_mapped_reopen();
+    test_file_dump();
+    test_plist();
+    test_queue_threads();
+    test_shared_threads();
+    test_pool_threads();
+
+    printf( "%d checks, %d failed\n", test_checks, test_failed );
+    return test_failed;
+}
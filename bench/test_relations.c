@@ -0,0 +1,320 @@
+// test_relations - behaviour of the relation registry and of admission
+// through it, against the same rules written out by hand
+//
+//   cc -O2 -std=c11 -I.. test_relations.c ../handy_list.c ../handy_tlist.c
+//      ../handy_vec.c -o test_relations -lpthread
+//   ./test_relations
+//
+// Each relation of the switch must take what its rule allows, and
+// relations registered at run time must see the window they asked for and
+// be refused when that window cannot fill them. admitBatch must decide
+// every item as admitItem called once per item would, and the memo cache
+// must change how often a relation runs, never what it answers.
+// Every failed check prints one line; the exit status is the number of
+// failures ( 0 when all pass ).
+
+#include "../listOfRelationsADT.c"
+
+static int          test_failed = 0;
+static int          test_checks = 0;
+static const char * test_name   = "";
+
+#define TEST_CHECK( cond )                                                          \
+    do                                                                              \
+    {                                                                               \
+        test_checks++;                                                              \
+        if( !( cond ) )                                                             \
+        {                                                                           \
+            test_failed++;                                                          \
+            printf( "FAIL %s:%d %s: %s\n", __FILE__, __LINE__, test_name, #cond );  \
+        }                                                                           \
+    } while( 0 )
+
+static uint64_t test_seed = 88172645463325252ull;
+
+static int  test_random     ( int below )
+{
+    // xorshift64
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 7;
+    test_seed ^= test_seed << 17;
+    return below > 0 ? (int)( test_seed % (uint64_t) below ) : 0;
+}
+
+// registered relations
+
+static int  test_calls;
+static int  test_arity;
+
+// the window and the new item sum to an even number
+static bool test_sum_even   ( const int * args, int arity )
+{
+    int sum = 0;
+
+    test_calls++;
+    test_arity = arity;
+    for( int i = 0; i < arity; i++ )
+        sum += args[i];
+    return sum % 2 == 0;
+}
+
+static bool test_always     ( const int * args, int arity )
+{
+    (void) args;
+    (void) arity;
+    return true;
+}
+
+static void test_registry   ()
+{
+    test_name = "registry";
+
+    int five = registerRelation( "sumEven5", 5, WINDOW_LAST_K, test_sum_even );
+
+    TEST_CHECK( five == REL_COUNT );
+    TEST_CHECK( registerRelation( "wide", RELATION_ARGS, WINDOW_LAST_K, test_always ) == REL_COUNT + 1 );
+    TEST_CHECK( registerRelation( "wider", RELATION_ARGS + 1, WINDOW_LAST_K, test_always ) == -1 );
+    TEST_CHECK( registerRelation( "ends", 4, WINDOW_FIRST_LAST, test_always ) == -1 );
+    TEST_CHECK( registerRelation( "none", 2, WINDOW_LAST_K, NULL ) == -1 );
+
+    // until four items are in there is no tuple of five, so nothing to check
+    handy_list_int admitted = handy_create_list_int( NULL );
+    int            kept[400];
+    int            size     = 0;
+
+    for( int n = 0; n < 400; n++ )
+    {
+        int  item = test_random( 1000 ) - 500;
+        int  sum  = item;
+        bool want;
+
+        for( int i = size - 4; i >= 0 && i < size; i++ )
+            sum += kept[i];
+        want = size < 4 || sum % 2 == 0;
+
+        test_calls = 0;
+        TEST_CHECK( admitItem( admitted, five, item ) == want );
+        TEST_CHECK( test_calls == ( size >= 4 ) );
+        if( size >= 4 )
+            TEST_CHECK( test_arity == 5 );
+        if( want )
+            kept[size++] = item;
+    }
+    TEST_CHECK( handy_list_int_length( admitted ) == size );
+
+    // a registered relation attaches next to those of the switch
+    struct relation_set set = { 0 };
+
+    TEST_CHECK( attachRelation( &set, five ) && attachRelation( &set, REL_ONE_ARG ) );
+    TEST_CHECK( admitAttached( admitted, &set, 3 ) == false );
+    TEST_CHECK( handy_list_int_length( admitted ) == size );
+
+    handy_list_int_free( admitted );
+    free( admitted );
+}
+
+static void test_registry_full  ()
+{
+    struct relation_set set = { 0 };
+
+    test_name = "registry full";
+
+    // every id is taken after RELATION_MAX relations
+    while( registerRelation( "fill", 1, WINDOW_LAST_K, test_always ) != -1 )
+        ;
+    TEST_CHECK( relationCount == RELATION_MAX );
+    TEST_CHECK( attachRelation( &set, RELATION_MAX - 1 ) );
+}
+
+// the relations of the switch
+
+static void test_dispatch   ()
+{
+    test_name = "dispatch";
+
+    // each relation of the switch by hand: the item, and the back of the
+    // list when there is one ( threeArg takes anything once there are two )
+    for( int id = 0; id < REL_COUNT; id++ )
+    {
+        handy_list_int admitted = handy_create_list_int( NULL );
+        int            size     = 0;
+        int            back     = 0;
+
+        for( int n = 0; n < 300; n++ )
+        {
+            int  item = test_random( 100 );
+            bool want = true;
+
+            switch( id )
+            {
+                case REL_REFLEXIVITY:
+                case REL_ONE_ARG:   want = item % 2 == 0; break;
+                case REL_SYMMETRY:  want = size == 0 || ( back % 2 == 0 && item % 2 == 0 ); break;
+                case REL_TWO_ARG:   want = size == 0 || back % 2 == 0 || item % 2 == 0; break;
+            }
+            TEST_CHECK( admitItem( admitted, id, item ) == want );
+            if( want )
+            {
+                size++;
+                back = item;
+            }
+        }
+        TEST_CHECK( handy_list_int_length( admitted ) == size );
+
+        handy_list_int_free( admitted );
+        free( admitted );
+    }
+
+    // nothing attaches past the registered ids
+    struct relation_set set = { 0 };
+
+    TEST_CHECK( attachRelation( &set, relationCount ) == false );
+    TEST_CHECK( attachRelation( &set, -1 ) == false );
+    TEST_CHECK( set.attached == 0 );
+}
+
+// batch admission
+
+// the items of list, oldest first, into out; how many there are
+static int  test_items      ( handy_list_int list, int * out )
+{
+    return handy_list_int_tail( list, out, handy_list_int_length( list ) );
+}
+
+static void test_batch      ()
+{
+    static const int sizes[] = { 0, 1, 2, 7, 63, 64, 65, 127, 128, 129, 300 };
+    // the last is the five-argument relation test_registry added
+    static const int ids[]   = { REL_ONE_ARG, REL_TWO_ARG, REL_THREE_ARG, REL_REFLEXIVITY, REL_COUNT };
+
+    test_name = "batch";
+
+    // admitBatch must take exactly what admitItem would, one by one, from
+    // empty lists and from lists whose back is odd or even
+    for( int i = 0; i < (int)( sizeof(ids) / sizeof(ids[0]) ); i++ )
+    {
+        for( int s = 0; s < (int)( sizeof(sizes) / sizeof(sizes[0]) ); s++ )
+        {
+            for( int start = 0; start < 3; start++ )
+            {
+                handy_list_int batch = handy_create_list_int( NULL );
+                handy_list_int one   = handy_create_list_int( NULL );
+                int            count = sizes[s];
+                int            items[300];
+                uint64_t       accepted[5];
+                int            taken = 0;
+
+                for( int n = 0; n < start; n++ )
+                {
+                    handy_list_int_add_back( batch, 2 * n + 1 );
+                    handy_list_int_add_back( one, 2 * n + 1 );
+                }
+                for( int n = 0; n < count; n++ )
+                    items[n] = test_random( 1000 ) - 500;
+
+                int got = admitBatch( batch, ids[i], items, count, accepted );
+
+                for( int n = 0; n < count; n++ )
+                {
+                    bool want = admitItem( one, ids[i], items[n] );
+
+                    TEST_CHECK( ( ( accepted[n / 64] >> ( n % 64 ) ) & 1 ) == want );
+                    taken += want;
+                }
+                TEST_CHECK( got == taken );
+
+                int  want_items[303];
+                int  got_items[303];
+                int  size = test_items( one, want_items );
+
+                TEST_CHECK( test_items( batch, got_items ) == size );
+                TEST_CHECK( memcmp( want_items, got_items, size * sizeof(int) ) == 0 );
+
+                handy_list_int_free( batch );
+                handy_list_int_free( one );
+                free( batch );
+                free( one );
+            }
+        }
+    }
+}
+
+// memo cache
+
+// item and the one before it sum to an even number, counting its calls
+static bool test_pair_even  ( const int * args, int arity )
+{
+    test_calls++;
+    return ( args[0] + args[arity - 1] ) % 2 == 0;
+}
+
+static void test_memo       ()
+{
+    int pair = registerRelation( "pairEven", 2, WINDOW_LAST_K, test_pair_even );
+
+    test_name = "memo";
+
+    // with the cache on and off, the same items must go in; a roomy cache
+    // runs the relation once per distinct pair, a tight one evicts
+    static const size_t capacities[] = { 0, 8, 1024 };
+
+    for( int c = 0; c < 3; c++ )
+    {
+        handy_list_int    admitted = handy_create_list_int( NULL );
+        struct memo_stats stats;
+        bool              seen[16][16] = { { false } };
+        int               distinct = 0;
+        int               back     = -1;
+        int               size     = 0;
+
+        if( capacities[c] > 0 )
+            TEST_CHECK( memoEnable( capacities[c] ) );
+        markRelationPure( pair, capacities[c] > 0 );
+        test_calls = 0;
+
+        for( int n = 0; n < 2000; n++ )
+        {
+            int  item = test_random( 16 );
+            bool want = back < 0 || ( back + item ) % 2 == 0;
+
+            if( back >= 0 && !seen[back][item] )
+            {
+                seen[back][item] = true;
+                distinct++;
+            }
+            TEST_CHECK( admitItem( admitted, pair, item ) == want );
+            if( want )
+            {
+                back = item;
+                size++;
+            }
+        }
+        TEST_CHECK( handy_list_int_length( admitted ) == size );
+
+        memoStats( &stats );
+        if( capacities[c] == 0 )
+            TEST_CHECK( stats.hits == 0 && stats.misses == 0 );
+        else
+            TEST_CHECK( stats.hits + stats.misses == 1999 && stats.misses == (unsigned long) test_calls );
+        if( capacities[c] == 1024 )
+            TEST_CHECK( test_calls == distinct && stats.evictions == 0 );
+        if( capacities[c] == 8 )
+            TEST_CHECK( test_calls > distinct && stats.evictions > 0 );
+
+        memoDisable();
+        handy_list_int_free( admitted );
+        free( admitted );
+    }
+}
+
+int main()
+{
+    test_dispatch();
+    test_registry();
+    test_batch();
+    test_memo();
+    test_registry_full();
+
+    printf( "%d checks, %d failed\n", test_checks, test_failed );
+    return test_failed;
+}
@@ -0,0 +1,388 @@
+// unrolled ( chunked ) implementation of the handy_list interface
+//
+// Elements sit in cache-line-aligned chunks of HANDY_CHUNK_ITEMS pointers,
+// chained both ways. Scans run over contiguous arrays, and a full chunk
+// costs about 8.8 bytes per element against 24 for a node. reverse only
+// flips the direction flag, like a node list: the handy_chunk_list_* entry
+// points map onto the physical order below.
+
+#include "handy_list.h"
+
+// 256 bytes per chunk: two links, a count and 29 item slots
+#define HANDY_CHUNK_BYTES   256
+#define HANDY_CHUNK_ITEMS   ( ( HANDY_CHUNK_BYTES - 3 * sizeof(void *) ) / sizeof(void *) )
+
+typedef struct __handy_chunk * _handy_chunk;
+
+struct __handy_chunk
+{
+    _handy_chunk _next;
+    _handy_chunk _prev;
+    size_t       _count;
+
+    void * _items[ HANDY_CHUNK_ITEMS ];
+};
+
+typedef struct _handy_chunk_list_struct * handy_chunk_list;
+
+struct _handy_chunk_list_struct
+{
+    struct _handy_list_struct _base;
+
+    _handy_chunk _head;
+    _handy_chunk _tail;
+};
+
+int    handy_chunk_list_contain     ( handy_list self, void * item );
+bool   handy_chunk_list_add_front   ( handy_list self, void * item );
+bool   handy_chunk_list_add_back    ( handy_list self, void * item );
+bool   handy_chunk_list_add_at      ( handy_list self, void * item, int at );
+bool   handy_chunk_list_empty       ( handy_list self );
+
+void * handy_chunk_list_get_front   ( handy_list self );
+void * handy_chunk_list_get_back    ( handy_list self );
+void * handy_chunk_list_get_at      ( handy_list self, int at );
+bool   handy_chunk_list_rem_front   ( handy_list self );
+bool   handy_chunk_list_rem_back    ( handy_list self );
+bool   handy_chunk_list_rem_at      ( handy_list self, int at );
+void   handy_chunk_list_reverse     ( handy_list self );
+void   handy_chunk_list_free        ( handy_list self );
+int    handy_chunk_list_length      ( handy_list self );
+
+static const struct _handy_list_ops handy_chunk_list_ops =
+{
+    .contain       = handy_chunk_list_contain,
+    .add_front     = handy_chunk_list_add_front,
+    .add_back      = handy_chunk_list_add_back,
+    .add_at        = handy_chunk_list_add_at,
+    .empty         = handy_chunk_list_empty,
+    .get_front     = handy_chunk_list_get_front,
+    .get_back      = handy_chunk_list_get_back,
+    .get_at        = handy_chunk_list_get_at,
+    .rem_front     = handy_chunk_list_rem_front,
+    .rem_back      = handy_chunk_list_rem_back,
+    .reverse       = handy_chunk_list_reverse,
+    .rem_at        = handy_chunk_list_rem_at,
+    .free          = handy_chunk_list_free,
+    .length        = handy_chunk_list_length,
+};
+
+handy_list handy_create_chunk_list  ()
+{
+    handy_chunk_list temp_list = malloc( sizeof(*temp_list) );
+    if( temp_list == NULL )
+        return NULL;
+
+    handy_list_init_header( &temp_list->_base, &handy_chunk_list_ops );
+    temp_list->_head = temp_list->_tail = NULL;
+
+    return &temp_list->_base;
+}
+
+// new empty chunk linked in after prev ( or at the head when prev is NULL )
+static _handy_chunk handy_chunk_new     ( handy_chunk_list self, _handy_chunk prev )
+{
+    _handy_chunk temp = aligned_alloc( 64, sizeof( *temp ) );
+    if( temp == NULL )
+        return NULL;
+
+    HANDY_STAT( &self->_base, allocs, 1 );
+
+    temp->_count = 0;
+    temp->_prev = prev;
+    temp->_next = prev != NULL ? prev->_next : self->_head;
+
+    if( temp->_next != NULL )
+        temp->_next->_prev = temp;
+    else
+        self->_tail = temp;
+
+    if( prev != NULL )
+        prev->_next = temp;
+    else
+        self->_head = temp;
+
+    return temp;
+}
+static void handy_chunk_unlink          ( handy_chunk_list self, _handy_chunk chunk )
+{
+    if( chunk->_prev != NULL )
+        chunk->_prev->_next = chunk->_next;
+    else
+        self->_head = chunk->_next;
+
+    if( chunk->_next != NULL )
+        chunk->_next->_prev = chunk->_prev;
+    else
+        self->_tail = chunk->_prev;
+
+    HANDY_STAT( &self->_base, frees, 1 );
+    free( chunk );
+}
+// chunk holding position at, and the offset of at inside it
+static _handy_chunk handy_chunk_find    ( handy_chunk_list self, int at, size_t * offset )
+{
+    _handy_chunk iter;
+
+    if( at < self->_base._size / 2 )
+    {
+        for( iter = self->_head; (size_t) at >= iter->_count; iter = iter->_next )
+        {
+            HANDY_STAT( &self->_base, hops, 1 );
+            at -= iter->_count;
+        }
+    }
+    else
+    {
+        // closer to the back: count down from the end
+        at = self->_base._size - 1 - at;
+        for( iter = self->_tail; (size_t) at >= iter->_count; iter = iter->_prev )
+        {
+            HANDY_STAT( &self->_base, hops, 1 );
+            at -= iter->_count;
+        }
+        at = iter->_count - 1 - at;
+    }
+
+    *offset = at;
+    return iter;
+}
+// keep chunks at least half full: fold chunk into its successor when both fit
+static void handy_chunk_merge_next      ( handy_chunk_list self, _handy_chunk chunk )
+{
+    _handy_chunk next = chunk->_next;
+
+    if( chunk->_count == 0 )
+    {
+        handy_chunk_unlink( self, chunk );
+        return;
+    }
+    if( next == NULL || chunk->_count >= HANDY_CHUNK_ITEMS / 2 ||
+        chunk->_count + next->_count > HANDY_CHUNK_ITEMS )
+        return;
+
+    memcpy( chunk->_items + chunk->_count, next->_items, next->_count * sizeof(void *) );
+    chunk->_count += next->_count;
+
+    handy_chunk_unlink( self, next );
+}
+
+static bool handy_chunk_add_front      ( handy_chunk_list list, void * item )
+{
+    _handy_chunk     head = list->_head;
+
+    if( head == NULL || head->_count == HANDY_CHUNK_ITEMS )
+    {
+        head = handy_chunk_new( list, NULL );
+        if( head == NULL )
+            return false;
+    }
+
+    memmove( head->_items + 1, head->_items, head->_count * sizeof(void *) );
+    head->_items[0] = item;
+    head->_count++;
+
+    list->_base._size++;
+    return true;
+}
+static bool handy_chunk_add_back       ( handy_chunk_list list, void * item )
+{
+    _handy_chunk     tail = list->_tail;
+
+    if( tail == NULL || tail->_count == HANDY_CHUNK_ITEMS )
+    {
+        tail = handy_chunk_new( list, tail );
+        if( tail == NULL )
+            return false;
+    }
+
+    tail->_items[ tail->_count++ ] = item;
+
+    list->_base._size++;
+    return true;
+}
+static bool handy_chunk_add_at         ( handy_chunk_list list, void * item, int at )
+{
+    if( at <= 0 )
+        return handy_chunk_add_front( list, item );
+    else if( at >= list->_base._size )
+        return handy_chunk_add_back( list, item );
+
+    size_t           offset;
+    _handy_chunk     chunk = handy_chunk_find( list, at, &offset );
+
+    if( chunk->_count == HANDY_CHUNK_ITEMS )
+    {
+        // split the full chunk in half and insert into whichever half
+        _handy_chunk half = handy_chunk_new( list, chunk );
+        if( half == NULL )
+            return false;
+
+        half->_count = HANDY_CHUNK_ITEMS / 2;
+        chunk->_count -= half->_count;
+        memcpy( half->_items, chunk->_items + chunk->_count, half->_count * sizeof(void *) );
+
+        if( offset > chunk->_count )
+        {
+            offset -= chunk->_count;
+            chunk = half;
+        }
+    }
+
+    memmove( chunk->_items + offset + 1, chunk->_items + offset,
+             ( chunk->_count - offset ) * sizeof(void *) );
+    chunk->_items[ offset ] = item;
+    chunk->_count++;
+
+    list->_base._size++;
+    return true;
+}
+static bool handy_chunk_rem_back       ( handy_chunk_list list )
+{
+    if( list->_base._size == 0 )
+        return false;
+
+    if( --list->_tail->_count == 0 )
+        handy_chunk_unlink( list, list->_tail );
+
+    list->_base._size--;
+    return true;
+}
+static bool handy_chunk_rem_at         ( handy_chunk_list list, int at )
+{
+    if( at < 0 || at >= list->_base._size )
+        return false;
+
+    size_t           offset;
+    _handy_chunk     chunk = handy_chunk_find( list, at, &offset );
+
+    chunk->_count--;
+    memmove( chunk->_items + offset, chunk->_items + offset + 1,
+             ( chunk->_count - offset ) * sizeof(void *) );
+
+    handy_chunk_merge_next( list, chunk );
+
+    list->_base._size--;
+    return true;
+}
+
+int    handy_chunk_list_contain     ( handy_list self, void * item )
+{
+    handy_chunk_list list = (handy_chunk_list) self;
+    int              index = 0;
+
+    // scan in list order, which runs from the tail in a reversed list
+    for( _handy_chunk iter = self->_reversed ? list->_tail : list->_head; iter != NULL;
+         iter = self->_reversed ? iter->_prev : iter->_next )
+    {
+        for( size_t i = 0; i < iter->_count; i++ )
+        {
+            if( iter->_items[ self->_reversed ? iter->_count - 1 - i : i ] == item )
+                return index + (int) i;
+        }
+        index += iter->_count;
+
+        HANDY_STAT( self, hops, 1 );
+    }
+    return -1;
+}
+bool   handy_chunk_list_add_front   ( handy_list self, void * item )
+{
+    handy_chunk_list list = (handy_chunk_list) self;
+    return self->_reversed ? handy_chunk_add_back( list, item ) : handy_chunk_add_front( list, item );
+}
+bool   handy_chunk_list_add_back    ( handy_list self, void * item )
+{
+    handy_chunk_list list = (handy_chunk_list) self;
+    return self->_reversed ? handy_chunk_add_front( list, item ) : handy_chunk_add_back( list, item );
+}
+bool   handy_chunk_list_add_at      ( handy_list self, void * item, int at )
+{
+    if( !self->_reversed )
+        return handy_chunk_add_at( (handy_chunk_list) self, item, at );
+
+    // inserting before logical at is inserting after its physical item
+    if( at < 0 )
+        at = 0;
+    return handy_chunk_add_at( (handy_chunk_list) self, item, self->_size - at );
+}
+bool   handy_chunk_list_empty       ( handy_list self )
+{
+    return self->_size == 0 ? true : false;
+}
+void * handy_chunk_list_get_front   ( handy_list self )
+{
+    if( self->_size == 0 )
+        return NULL;
+
+    if( self->_reversed )
+    {
+        _handy_chunk tail = ((handy_chunk_list) self)->_tail;
+        return tail->_items[ tail->_count - 1 ];
+    }
+    return ((handy_chunk_list) self)->_head->_items[0];
+}
+void * handy_chunk_list_get_back    ( handy_list self )
+{
+    if( self->_size == 0 )
+        return NULL;
+
+    if( !self->_reversed )
+    {
+        _handy_chunk tail = ((handy_chunk_list) self)->_tail;
+        return tail->_items[ tail->_count - 1 ];
+    }
+    return ((handy_chunk_list) self)->_head->_items[0];
+}
+void * handy_chunk_list_get_at      ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return NULL;
+
+    size_t       offset;
+    _handy_chunk chunk = handy_chunk_find( (handy_chunk_list) self, self->_reversed ? self->_size - 1 - at : at, &offset );
+
+    return chunk->_items[ offset ];
+}
+bool   handy_chunk_list_rem_front   ( handy_list self )
+{
+    handy_chunk_list list = (handy_chunk_list) self;
+    return self->_reversed ? handy_chunk_rem_back( list ) : handy_chunk_rem_at( list, 0 );
+}
+bool   handy_chunk_list_rem_back    ( handy_list self )
+{
+    handy_chunk_list list = (handy_chunk_list) self;
+    return self->_reversed ? handy_chunk_rem_at( list, 0 ) : handy_chunk_rem_back( list );
+}
+bool   handy_chunk_list_rem_at      ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return false;
+
+    return handy_chunk_rem_at( (handy_chunk_list) self, self->_reversed ? self->_size - 1 - at : at );
+}
+void   handy_chunk_list_reverse     ( handy_list self )
+{
+    // the chunks stay put; every entry point reads the flag
+    self->_reversed = !self->_reversed;
+}
+void   handy_chunk_list_free        ( handy_list self )
+{
+    handy_chunk_list list = (handy_chunk_list) self;
+
+    while( list->_head != NULL )
+    {
+        _handy_chunk next = list->_head->_next;
+
+        HANDY_STAT( self, frees, 1 );
+        free( list->_head );
+        list->_head = next;
+    }
+    list->_tail = NULL;
+    self->_size = 0;
+    self->_reversed = false;
+}
+int    handy_chunk_list_length      ( handy_list self )
+{
+    return self->_size;
+}
@@ -0,0 +1,341 @@
+// ring buffer ( deque ) implementation of the handy_list interface
+//
+// Items sit in one power-of-two array used as a circle from _head on, so
+// both ends grow and shrink in O(1) without a per-item allocation, and a
+// position is plain index arithmetic. The array doubles when full and
+// halves when a quarter full. add_at and rem_at move the shorter side.
+// reverse only flips the reading direction.
+
+#include "handy_list.h"
+
+#define HANDY_DEQUE_MIN     16
+
+typedef struct _handy_deque_list_struct * handy_deque_list;
+
+struct _handy_deque_list_struct
+{
+    struct _handy_list_struct _base;
+
+    void ** _items;
+    size_t  _mask;                  // capacity - 1
+    size_t  _head;                  // slot of physical position 0
+};
+
+int    handy_deque_list_contain     ( handy_list self, void * item );
+bool   handy_deque_list_add_front   ( handy_list self, void * item );
+bool   handy_deque_list_add_back    ( handy_list self, void * item );
+bool   handy_deque_list_add_at      ( handy_list self, void * item, int at );
+bool   handy_deque_list_empty       ( handy_list self );
+
+void * handy_deque_list_get_front   ( handy_list self );
+void * handy_deque_list_get_back    ( handy_list self );
+void * handy_deque_list_get_at      ( handy_list self, int at );
+bool   handy_deque_list_rem_front   ( handy_list self );
+bool   handy_deque_list_rem_back    ( handy_list self );
+bool   handy_deque_list_rem_at      ( handy_list self, int at );
+void   handy_deque_list_reverse     ( handy_list self );
+void   handy_deque_list_free        ( handy_list self );
+int    handy_deque_list_length      ( handy_list self );
+
+static const struct _handy_list_ops handy_deque_list_ops =
+{
+    .contain       = handy_deque_list_contain,
+    .add_front     = handy_deque_list_add_front,
+    .add_back      = handy_deque_list_add_back,
+    .add_at        = handy_deque_list_add_at,
+    .empty         = handy_deque_list_empty,
+    .get_front     = handy_deque_list_get_front,
+    .get_back      = handy_deque_list_get_back,
+    .get_at        = handy_deque_list_get_at,
+    .rem_front     = handy_deque_list_rem_front,
+    .rem_back      = handy_deque_list_rem_back,
+    .reverse       = handy_deque_list_reverse,
+    .rem_at        = handy_deque_list_rem_at,
+    .free          = handy_deque_list_free,
+    .length        = handy_deque_list_length,
+};
+
+handy_list handy_create_deque_list  ()
+{
+    handy_deque_list temp_list = malloc( sizeof(*temp_list) );
+    if( temp_list == NULL )
+        return NULL;
+
+    handy_list_init_header( &temp_list->_base, &handy_deque_list_ops );
+    temp_list->_items = NULL;
+    temp_list->_mask = 0;
+    temp_list->_head = 0;
+
+    return &temp_list->_base;
+}
+
+// slot of physical position at
+static inline size_t handy_deque_slot   ( handy_deque_list self, size_t at )
+{
+    return ( self->_head + at ) & self->_mask;
+}
+// physical position of logical position at
+static inline size_t handy_deque_pos    ( handy_deque_list self, int at )
+{
+    return self->_base._reversed ? (size_t)( self->_base._size - 1 - at ) : (size_t) at;
+}
+// move the items into a new array of capacity slots, unwrapped from 0
+static bool handy_deque_resize          ( handy_deque_list self, size_t capacity )
+{
+    void ** items = malloc( capacity * sizeof(void *) );
+    if( items == NULL )
+        return false;
+
+    HANDY_STAT( &self->_base, allocs, 1 );
+
+    size_t size = self->_base._size;
+
+    if( size > 0 )
+    {
+        // at most two runs: head to the end of the array, then the wrap
+        size_t run = self->_mask + 1 - self->_head;
+        if( run > size )
+            run = size;
+
+        memcpy( items, self->_items + self->_head, run * sizeof(void *) );
+        memcpy( items + run, self->_items, ( size - run ) * sizeof(void *) );
+    }
+
+    if( self->_items != NULL )
+    {
+        HANDY_STAT( &self->_base, frees, 1 );
+        free( self->_items );
+    }
+
+    self->_items = items;
+    self->_mask = capacity - 1;
+    self->_head = 0;
+    return true;
+}
+static bool handy_deque_grow            ( handy_deque_list self )
+{
+    if( self->_items == NULL )
+        return handy_deque_resize( self, HANDY_DEQUE_MIN );
+    if( (size_t) self->_base._size <= self->_mask )
+        return true;
+
+    return handy_deque_resize( self, ( self->_mask + 1 ) * 2 );
+}
+static void handy_deque_shrink          ( handy_deque_list self )
+{
+    size_t capacity = self->_mask + 1;
+
+    // halving may fail harmlessly: the items stay where they are
+    if( capacity > HANDY_DEQUE_MIN && (size_t) self->_base._size < capacity / 4 )
+        handy_deque_resize( self, capacity / 2 );
+}
+
+// physical ends
+
+static bool handy_deque_push_front      ( handy_deque_list self, void * item )
+{
+    if( !handy_deque_grow( self ) )
+        return false;
+
+    self->_head = ( self->_head - 1 ) & self->_mask;
+    self->_items[ self->_head ] = item;
+
+    self->_base._size++;
+    return true;
+}
+static bool handy_deque_push_back       ( handy_deque_list self, void * item )
+{
+    if( !handy_deque_grow( self ) )
+        return false;
+
+    self->_items[ handy_deque_slot( self, self->_base._size ) ] = item;
+
+    self->_base._size++;
+    return true;
+}
+static bool handy_deque_pop_front       ( handy_deque_list self )
+{
+    if( self->_base._size == 0 )
+        return false;
+
+    self->_head = ( self->_head + 1 ) & self->_mask;
+    self->_base._size--;
+
+    handy_deque_shrink( self );
+    return true;
+}
+static bool handy_deque_pop_back        ( handy_deque_list self )
+{
+    if( self->_base._size == 0 )
+        return false;
+
+    self->_base._size--;
+
+    handy_deque_shrink( self );
+    return true;
+}
+
+int    handy_deque_list_contain     ( handy_list self, void * item )
+{
+    handy_deque_list list = (handy_deque_list) self;
+    size_t           size = self->_size;
+
+    if( size == 0 )
+        return -1;
+
+    // the first match in reading order: from the front, or from the back
+    // when reversed
+    size_t run = list->_mask + 1 - list->_head;
+    if( run > size )
+        run = size;
+
+    if( !self->_reversed )
+    {
+        for( size_t i = 0; i < run; i++ )
+        {
+            if( list->_items[ list->_head + i ] == item )
+                return (int) i;
+        }
+        for( size_t i = 0; i < size - run; i++ )
+        {
+            if( list->_items[i] == item )
+                return (int)( run + i );
+        }
+    }
+    else
+    {
+        for( size_t i = size - run; i > 0; i-- )
+        {
+            if( list->_items[ i - 1 ] == item )
+                return (int)( size - run - i );
+        }
+        for( size_t i = run; i > 0; i-- )
+        {
+            if( list->_items[ list->_head + i - 1 ] == item )
+                return (int)( size - i );
+        }
+    }
+    return -1;
+}
+bool   handy_deque_list_add_front   ( handy_list self, void * item )
+{
+    handy_deque_list list = (handy_deque_list) self;
+
+    return self->_reversed ? handy_deque_push_back( list, item ) : handy_deque_push_front( list, item );
+}
+bool   handy_deque_list_add_back    ( handy_list self, void * item )
+{
+    handy_deque_list list = (handy_deque_list) self;
+
+    return self->_reversed ? handy_deque_push_front( list, item ) : handy_deque_push_back( list, item );
+}
+bool   handy_deque_list_add_at      ( handy_list self, void * item, int at )
+{
+    if( at <= 0 )
+        return handy_deque_list_add_front( self, item );
+    else if( at >= self->_size )
+        return handy_deque_list_add_back( self, item );
+
+    handy_deque_list list = (handy_deque_list) self;
+
+    if( !handy_deque_grow( list ) )
+        return false;
+
+    // physical position the item ends up at
+    size_t pos = self->_reversed ? (size_t)( self->_size - at ) : (size_t) at;
+    size_t size = self->_size;
+
+    if( pos < size / 2 )
+    {
+        // open the gap by moving the front part one slot down
+        list->_head = ( list->_head - 1 ) & list->_mask;
+        for( size_t i = 0; i < pos; i++ )
+            list->_items[ handy_deque_slot( list, i ) ] = list->_items[ handy_deque_slot( list, i + 1 ) ];
+    }
+    else
+    {
+        for( size_t i = size; i > pos; i-- )
+            list->_items[ handy_deque_slot( list, i ) ] = list->_items[ handy_deque_slot( list, i - 1 ) ];
+    }
+    list->_items[ handy_deque_slot( list, pos ) ] = item;
+
+    self->_size++;
+    return true;
+}
+bool   handy_deque_list_empty       ( handy_list self )
+{
+    return self->_size == 0 ? true : false;
+}
+void * handy_deque_list_get_front   ( handy_list self )
+{
+    return handy_deque_list_get_at( self, 0 );
+}
+void * handy_deque_list_get_back    ( handy_list self )
+{
+    return handy_deque_list_get_at( self, self->_size - 1 );
+}
+void * handy_deque_list_get_at      ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return NULL;
+
+    handy_deque_list list = (handy_deque_list) self;
+    return list->_items[ handy_deque_slot( list, handy_deque_pos( list, at ) ) ];
+}
+bool   handy_deque_list_rem_front   ( handy_list self )
+{
+    handy_deque_list list = (handy_deque_list) self;
+
+    return self->_reversed ? handy_deque_pop_back( list ) : handy_deque_pop_front( list );
+}
+bool   handy_deque_list_rem_back    ( handy_list self )
+{
+    handy_deque_list list = (handy_deque_list) self;
+
+    return self->_reversed ? handy_deque_pop_front( list ) : handy_deque_pop_back( list );
+}
+bool   handy_deque_list_rem_at      ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return false;
+
+    handy_deque_list list = (handy_deque_list) self;
+    size_t           pos = handy_deque_pos( list, at );
+    size_t           size = self->_size;
+
+    if( pos < size / 2 )
+    {
+        // close the gap from the front side
+        for( size_t i = pos; i > 0; i-- )
+            list->_items[ handy_deque_slot( list, i ) ] = list->_items[ handy_deque_slot( list, i - 1 ) ];
+        return handy_deque_pop_front( list );
+    }
+
+    for( size_t i = pos; i + 1 < size; i++ )
+        list->_items[ handy_deque_slot( list, i ) ] = list->_items[ handy_deque_slot( list, i + 1 ) ];
+    return handy_deque_pop_back( list );
+}
+void   handy_deque_list_reverse     ( handy_list self )
+{
+    self->_reversed = !self->_reversed;
+}
+void   handy_deque_list_free        ( handy_list self )
+{
+    handy_deque_list list = (handy_deque_list) self;
+
+    if( list->_items != NULL )
+    {
+        HANDY_STAT( self, frees, 1 );
+        free( list->_items );
+    }
+
+    list->_items = NULL;
+    list->_mask = 0;
+    list->_head = 0;
+    self->_size = 0;
+    self->_reversed = false;
+}
+int    handy_deque_list_length      ( handy_list self )
+{
+    return self->_size;
+}
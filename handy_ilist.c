@@ -0,0 +1,180 @@
+#include "handy_ilist.h"
+
+handy_ilist handy_create_ilist  ()
+{
+    handy_ilist temp_list = malloc( sizeof(*temp_list) );
+    if( temp_list == NULL )
+        return NULL;
+
+    handy_ilist_init( temp_list );
+    return temp_list;
+}
+void   handy_ilist_init         ( handy_ilist self )
+{
+    self->_first = self->_last = NULL;
+    self->_size = 0;
+}
+bool   handy_ilist_add_front    ( handy_ilist self, struct handy_ilink * link )
+{
+    return handy_ilist_add_before( self, link, self->_first );
+}
+bool   handy_ilist_add_back     ( handy_ilist self, struct handy_ilink * link )
+{
+    return handy_ilist_add_before( self, link, NULL );
+}
+bool   handy_ilist_add_at       ( handy_ilist self, struct handy_ilink * link, int at )
+{
+    if( at <= 0 )
+        return handy_ilist_add_front( self, link );
+    else if( at >= self->_size )
+        return handy_ilist_add_back( self, link );
+
+    return handy_ilist_add_before( self, link, handy_ilist_get_at( self, at ) );
+}
+// link in front of at; NULL at means the back
+bool   handy_ilist_add_before   ( handy_ilist self, struct handy_ilink * link, struct handy_ilink * at )
+{
+    link->_next = at;
+    link->_prev = at != NULL ? at->_prev : self->_last;
+
+    if( link->_prev != NULL )
+        link->_prev->_next = link;
+    else
+        self->_first = link;
+
+    if( at != NULL )
+        at->_prev = link;
+    else
+        self->_last = link;
+
+    self->_size++;
+    return true;
+}
+struct handy_ilink * handy_ilist_get_front ( handy_ilist self )
+{
+    return self->_first;
+}
+struct handy_ilink * handy_ilist_get_back  ( handy_ilist self )
+{
+    return self->_last;
+}
+struct handy_ilink * handy_ilist_get_at    ( handy_ilist self, int at )
+{
+    struct handy_ilink * iter;
+
+    if( at < 0 || at >= self->_size )
+        return NULL;
+
+    // walk from the nearer end
+    if( at < self->_size / 2 )
+    {
+        for( iter = self->_first; at > 0; at-- )
+            iter = iter->_next;
+    }
+    else
+    {
+        for( iter = self->_last, at = self->_size - 1 - at; at > 0; at-- )
+            iter = iter->_prev;
+    }
+    return iter;
+}
+void   handy_ilist_rem          ( handy_ilist self, struct handy_ilink * link )
+{
+    if( link->_prev != NULL )
+        link->_prev->_next = link->_next;
+    else
+        self->_first = link->_next;
+
+    if( link->_next != NULL )
+        link->_next->_prev = link->_prev;
+    else
+        self->_last = link->_prev;
+
+    link->_next = link->_prev = NULL;
+    self->_size--;
+}
+bool   handy_ilist_rem_front    ( handy_ilist self )
+{
+    if( self->_size == 0 )
+        return false;
+
+    handy_ilist_rem( self, self->_first );
+    return true;
+}
+bool   handy_ilist_rem_back     ( handy_ilist self )
+{
+    if( self->_size == 0 )
+        return false;
+
+    handy_ilist_rem( self, self->_last );
+    return true;
+}
+bool   handy_ilist_rem_at       ( handy_ilist self, int at )
+{
+    struct handy_ilink * link = handy_ilist_get_at( self, at );
+
+    if( link == NULL )
+        return false;
+
+    handy_ilist_rem( self, link );
+    return true;
+}
+int    handy_ilist_contain      ( handy_ilist self, struct handy_ilink * link )
+{
+    int i = 0;
+
+    for( struct handy_ilink * iter = self->_first; iter != NULL; iter = iter->_next, i++ )
+    {
+        if( iter == link )
+            return i;
+    }
+    return -1;
+}
+int    handy_ilist_find         ( handy_ilist self, bool (*eq)( struct handy_ilink * link, void * ctx ), void * ctx )
+{
+    int i = 0;
+
+    for( struct handy_ilink * iter = self->_first; iter != NULL; iter = iter->_next, i++ )
+    {
+        if( eq( iter, ctx ) )
+            return i;
+    }
+    return -1;
+}
+void   handy_ilist_reverse      ( handy_ilist self )
+{
+    // the objects cannot trade places, so every link turns around
+    struct handy_ilink * iter = self->_first;
+
+    self->_first = self->_last;
+    self->_last = iter;
+
+    while( iter != NULL )
+    {
+        struct handy_ilink * next = iter->_next;
+
+        iter->_next = iter->_prev;
+        iter->_prev = next;
+        iter = next;
+    }
+}
+bool   handy_ilist_empty        ( handy_ilist self )
+{
+    return self->_size == 0;
+}
+int    handy_ilist_length       ( handy_ilist self )
+{
+    return self->_size;
+}
+void   handy_ilist_clear        ( handy_ilist self )
+{
+    while( self->_first != NULL )
+    {
+        struct handy_ilink * next = self->_first->_next;
+
+        self->_first->_next = self->_first->_prev = NULL;
+        self->_first = next;
+    }
+    self->_last = NULL;
+    self->_size = 0;
+}
@@ -0,0 +1,65 @@
+// header definition of handy_ilist( intrusive linked list ) data structure
+//
+// The links live inside the stored object: embed a struct handy_ilink in
+// your struct and hand its address to the list. Adding never allocates,
+// and walking touches the object itself, not a wrapper node pointing at
+// it. handy_ilist_entry() gets back from a link to its object.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifndef HANDY_ILIST_H
+#define HANDY_ILIST_H
+
+struct handy_ilink
+{
+    struct handy_ilink * _next;
+    struct handy_ilink * _prev;
+};
+
+typedef struct _handy_ilist_struct * handy_ilist;
+
+struct _handy_ilist_struct
+{
+    struct handy_ilink * _first;
+    struct handy_ilink * _last;
+
+    int _size;
+};
+
+// object of type whose member field is the link
+#define handy_ilist_entry( link, type, member ) \
+    ( (type *)( (char *)( link ) - offsetof( type, member ) ) )
+
+extern handy_ilist handy_create_ilist();
+// ready a list header that is embedded or on the stack
+extern void  handy_ilist_init       ( handy_ilist self );
+
+extern bool  handy_ilist_add_front  ( handy_ilist self, struct handy_ilink * link );
+extern bool  handy_ilist_add_back   ( handy_ilist self, struct handy_ilink * link );
+extern bool  handy_ilist_add_at     ( handy_ilist self, struct handy_ilink * link, int at );
+extern bool  handy_ilist_add_before ( handy_ilist self, struct handy_ilink * link, struct handy_ilink * at );
+
+extern struct handy_ilink * handy_ilist_get_front ( handy_ilist self );
+extern struct handy_ilink * handy_ilist_get_back  ( handy_ilist self );
+extern struct handy_ilink * handy_ilist_get_at    ( handy_ilist self, int at );
+
+// unlink the object; O(1), the list needs no search
+extern void  handy_ilist_rem        ( handy_ilist self, struct handy_ilink * link );
+extern bool  handy_ilist_rem_front  ( handy_ilist self );
+extern bool  handy_ilist_rem_back   ( handy_ilist self );
+extern bool  handy_ilist_rem_at     ( handy_ilist self, int at );
+
+// index of the link, or -1
+extern int   handy_ilist_contain    ( handy_ilist self, struct handy_ilink * link );
+// index of the first object eq accepts, or -1
+extern int   handy_ilist_find       ( handy_ilist self, bool (*eq)( struct handy_ilink * link, void * ctx ), void * ctx );
+
+extern void  handy_ilist_reverse    ( handy_ilist self );
+extern bool  handy_ilist_empty      ( handy_ilist self );
+extern int   handy_ilist_length     ( handy_ilist self );
+// unlink every object; the objects themselves belong to the caller
+extern void  handy_ilist_clear      ( handy_ilist self );
+
+#endif //HANDY_ILIST_H
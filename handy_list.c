@@ -1,309 +1,2027 @@
 #include "handy_list.h"
+#include "defs.h"
 
-int    handy_list_contain       ( handy_list self, void * item );
-bool   handy_list_add_front     ( handy_list self, void * item );
-bool   handy_list_add_back      ( handy_list self, void * item );
-bool   handy_list_add_at        ( handy_list self, void * item, int at );
-bool   handy_list_empty         ( handy_list self );
-
-void * handy_list_get_front     ( handy_list self );
-void * handy_list_get_back      ( handy_list self );
-void * handy_list_get_at        ( handy_list self, int at );
-bool   handy_list_rem_front     ( handy_list self );
-bool   handy_list_rem_back      ( handy_list self );
-bool   handy_list_rem_at        ( handy_list self, int at );
-void   handy_list_reverse       ( handy_list self );
-void   handy_list_free          ( handy_list self );
-int    handy_list_length        ( handy_list self );
+#include <stdint.h>
+#include <pthread.h>
 
+int    handy_node_list_contain       ( handy_list self, void * item );
+bool   handy_node_list_add_front     ( handy_list self, void * item );
+bool   handy_node_list_add_back      ( handy_list self, void * item );
+bool   handy_node_list_add_at        ( handy_list self, void * item, int at );
+bool   handy_node_list_empty         ( handy_list self );
+
+void * handy_node_list_get_front     ( handy_list self );
+void * handy_node_list_get_back      ( handy_list self );
+void * handy_node_list_get_at        ( handy_list self, int at );
+bool   handy_node_list_rem_front     ( handy_list self );
+bool   handy_node_list_rem_back      ( handy_list self );
+bool   handy_node_list_rem_at        ( handy_list self, int at );
+void   handy_node_list_reverse       ( handy_list self );
+void   handy_node_list_free          ( handy_list self );
+int    handy_node_list_length        ( handy_list self );
+
+// the same operations on the physical node order; the handy_node_list_*
+// entry points map onto these through the direction flag
+static bool   handy_node_add_front   ( handy_list self, void * item );
+static bool   handy_node_add_back    ( handy_list self, void * item );
+static bool   handy_node_add_at      ( handy_list self, void * item, int at );
+static void * handy_node_get_at      ( handy_list self, int at );
+static bool   handy_node_rem_front   ( handy_list self );
+static bool   handy_node_rem_back    ( handy_list self );
+static bool   handy_node_rem_at      ( handy_list self, int at );
+
+// room in the hash index, taken before any node is linked
+static bool   handy_hash_reserve     ( handy_list self, int count );
+
+// node pool: list nodes are carved out of slabs and recycled through a
+// free list linked by _next, so a node costs a pointer pop instead of a
+// malloc, and a whole chain of nodes can be given back in one step.
+// Every thread has one pool per node size and takes no lock on it.
+//
+// Slabs are aligned to their size, so a node finds the slab, and the slab
+// the pool, that made it. A node freed on another thread goes back to its
+// own pool through that pool's remote stack, which the owner empties into
+// its free list when it runs dry. _remote_frees counts those nodes; the
+// owner counts the rest itself, so no node in use is ever in a free list
+// and trim sees every node that is out. A thread that exits hands its pool
+// over to the last node to come back, which frees it.
+
+#define HANDY_POOL_SLAB_BYTES 16384
+
+typedef struct __handy_pool_slab * _handy_pool_slab;
+typedef struct __handy_pool      * _handy_pool;
+
+struct __handy_pool_slab
+{
+    _handy_pool_slab _next;
+    _handy_pool      _pool;
+    char _nodes[];
+};
+
+struct __handy_pool
+{
+    size_t           _node_size;
+    int              _slab_nodes;
+    _handy_list_obj  _free;         // recycled nodes, linked by _next
+    _handy_pool_slab _slabs;        // every slab owned by this pool
+    int              _bump;         // next untouched node in _slabs
+    long             _local_live;   // made minus freed on the owner thread
+
+    _handy_list_obj  _remote;       // freed on other threads, linked by _next
+    long             _remote_frees; // how many; less _local_live once orphaned
+
+    struct handy_list_pool_stats _stats;
+};
+
+// plain nodes, and nodes of lists carrying an order-statistics index
+static _Thread_local _handy_pool handy_pools[2];
+
+static const size_t    handy_pool_sizes[2] =
+{
+    sizeof( struct __handy_list_obj ), sizeof( struct __handy_list_inode )
+};
+
+static pthread_key_t   handy_pool_key;
+static pthread_once_t  handy_pool_once = PTHREAD_ONCE_INIT;
+
+static void handy_pool_release  ( _handy_pool pool )
+{
+    while( pool->_slabs != NULL )
+    {
+        _handy_pool_slab next = pool->_slabs->_next;
+        free( pool->_slabs );
+        pool->_slabs = next;
+    }
+    free( pool );
+}
+// thread exit: free the pool now if nothing is out, else leave that to
+// the remote free that brings the count to zero
+static void handy_pool_orphan   ( void * pools )
+{
+    for( int i = 0; i < 2; i++ )
+    {
+        _handy_pool pool = ((_handy_pool *) pools)[i];
+        if( pool == NULL )
+            continue;
+
+        ((_handy_pool *) pools)[i] = NULL;
+        if( __atomic_sub_fetch( &pool->_remote_frees, pool->_local_live, __ATOMIC_ACQ_REL ) == 0 )
+            handy_pool_release( pool );
+    }
+}
+static void handy_pool_key_init ()
+{
+    pthread_key_create( &handy_pool_key, handy_pool_orphan );
+}
+static _handy_pool     handy_pool_local ( int kind )
+{
+    if( handy_pools[ kind ] != NULL )
+        return handy_pools[ kind ];
+
+    _handy_pool pool = calloc( 1, sizeof( *pool ) );
+    if( pool == NULL )
+        return NULL;
+
+    pool->_node_size = handy_pool_sizes[ kind ];
+    pool->_slab_nodes = ( HANDY_POOL_SLAB_BYTES - sizeof( struct __handy_pool_slab ) ) / pool->_node_size;
+    pool->_bump = pool->_slab_nodes;
+
+    // the key's destructor runs at thread exit
+    pthread_once( &handy_pool_once, handy_pool_key_init );
+    pthread_setspecific( handy_pool_key, handy_pools );
+
+    return handy_pools[ kind ] = pool;
+}
+static _handy_pool     handy_pool_of   ( handy_list self )
+{
+    return handy_pool_local( (self->_flags & HANDY_LIST_INDEXED) ? 1 : 0 );
+}
+static _handy_pool     handy_pool_owner ( _handy_list_obj node )
+{
+    return ((_handy_pool_slab)( (uintptr_t) node & ~(uintptr_t)( HANDY_POOL_SLAB_BYTES - 1 ) ))->_pool;
+}
+static long            handy_pool_live  ( _handy_pool pool )
+{
+    return pool->_local_live - __atomic_load_n( &pool->_remote_frees, __ATOMIC_ACQUIRE );
+}
+// a fresh slab at the head of the pool's slabs
+static bool handy_pool_grow     ( _handy_pool pool )
+{
+    _handy_pool_slab slab = aligned_alloc( HANDY_POOL_SLAB_BYTES, HANDY_POOL_SLAB_BYTES );
+    if( slab == NULL )
+        return false;
+
+    slab->_pool = pool;
+    slab->_next = pool->_slabs;
+    pool->_slabs = slab;
+    pool->_bump = 0;
+
+    pool->_stats.slab_mallocs++;
+    return true;
+}
+static _handy_list_obj handy_pool_get  ( _handy_pool pool, void * item )
+{
+    _handy_list_obj temp;
+
+    if( pool == NULL )
+        return NULL;
+
+    // out of recycled nodes: take back what other threads freed
+    if( pool->_free == NULL && __atomic_load_n( &pool->_remote, __ATOMIC_RELAXED ) != NULL )
+        pool->_free = __atomic_exchange_n( &pool->_remote, NULL, __ATOMIC_ACQUIRE );
+
+    if( pool->_free != NULL )
+    {
+        temp = pool->_free;
+        pool->_free = temp->_next;
+    }
+    else
+    {
+        if( pool->_bump == pool->_slab_nodes && !handy_pool_grow( pool ) )
+            return NULL;
+
+        temp = (_handy_list_obj)( pool->_slabs->_nodes + pool->_node_size * pool->_bump++ );
+    }
+
+    temp->_data = item;
+    temp->_next = temp->_prev = NULL;
+
+    pool->_stats.node_allocs++;
+    pool->_local_live++;
+
+    return temp;
+}
+// give back a chain of count nodes linked first .. last through _next,
+// all made by pool
+static void handy_pool_put_chain ( _handy_pool pool, _handy_list_obj first, _handy_list_obj last, int count )
+{
+    _handy_pool * local = handy_pools + ( pool->_node_size == handy_pool_sizes[0] ? 0 : 1 );
+
+    if( *local == pool )
+    {
+        last->_next = pool->_free;
+        pool->_free = first;
+
+        pool->_stats.node_frees += count;
+        pool->_local_live -= count;
+        return;
+    }
+
+    // another thread's pool: push the chain, then count it. The count
+    // only reaches zero when the owner has exited and this was the last
+    // node out
+    _handy_list_obj head = __atomic_load_n( &pool->_remote, __ATOMIC_RELAXED );
+    do
+        last->_next = head;
+    while( !__atomic_compare_exchange_n( &pool->_remote, &head, first, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+
+    if( __atomic_add_fetch( &pool->_remote_frees, count, __ATOMIC_ACQ_REL ) == 0 )
+        handy_pool_release( pool );
+}
+static void handy_pool_put     ( _handy_list_obj node )
+{
+    handy_pool_put_chain( handy_pool_owner( node ), node, node, 1 );
+}
+// a chain of count nodes from any pools: runs from one pool go back in one
+// step each
+static void handy_pool_put_mixed ( _handy_list_obj first, int count )
+{
+    while( count > 0 )
+    {
+        _handy_pool     pool = handy_pool_owner( first );
+        _handy_list_obj last = first;
+        int             run = 1;
+
+        while( run < count && handy_pool_owner( last->_next ) == pool )
+        {
+            last = last->_next;
+            run++;
+        }
+
+        _handy_list_obj next = last->_next;
+
+        handy_pool_put_chain( pool, first, last, run );
+        first = next;
+        count -= run;
+    }
+}
+// up to count nodes in one contiguous block, from the rest of the current
+// slab or a fresh one; *got tells how many
+static char * handy_pool_get_block ( _handy_pool pool, int count, int * got )
+{
+    if( pool == NULL )
+        return NULL;
+
+    if( pool->_bump == pool->_slab_nodes && !handy_pool_grow( pool ) )
+        return NULL;
+
+    char * block = pool->_slabs->_nodes + pool->_node_size * pool->_bump;
+
+    *got = pool->_slab_nodes - pool->_bump < count ? pool->_slab_nodes - pool->_bump : count;
+    pool->_bump += *got;
+
+    pool->_stats.node_allocs += *got;
+    pool->_local_live += *got;
+
+    return block;
+}
+// node traffic of one list, counted for the instrumentation. _pool
+// remembers the pool every node of the list came from, so the list can go
+// back in one step; HANDY_POOL_MIXED once they come from several.
+#define HANDY_POOL_MIXED ( (struct __handy_pool *) 1 )
+
+static void handy_pool_note     ( handy_list self, _handy_pool pool )
+{
+    if( pool != NULL && self->_pool != pool )
+        self->_pool = self->_pool == NULL ? pool : HANDY_POOL_MIXED;
+}
+static _handy_list_obj handy_node_alloc ( handy_list self, void * item )
+{
+    // a hashed list that cannot index one more node cannot take it either
+    if( ( self->_flags & HANDY_LIST_HASHED ) && !handy_hash_reserve( self, 1 ) )
+        return NULL;
+
+    _handy_pool     pool = handy_pool_of( self );
+    _handy_list_obj temp = handy_pool_get( pool, item );
+
+    if( temp != NULL )
+    {
+        HANDY_STAT( self, allocs, 1 );
+        handy_pool_note( self, pool );
+    }
+    return temp;
+}
+static void handy_node_free             ( handy_list self, _handy_list_obj node )
+{
+    (void) self;
+
+    HANDY_STAT( self, frees, 1 );
+    handy_pool_put( node );
+}
+void   handy_list_pool_stats    ( struct handy_list_pool_stats * out )
+{
+    memset( out, 0, sizeof( *out ) );
+
+    for( int i = 0; i < 2; i++ )
+    {
+        _handy_pool pool = handy_pools[i];
+        if( pool == NULL )
+            continue;
+
+        long remote = __atomic_load_n( &pool->_remote_frees, __ATOMIC_ACQUIRE );
+
+        out->node_allocs  += pool->_stats.node_allocs;
+        out->node_frees   += pool->_stats.node_frees + remote;
+        out->slab_mallocs += pool->_stats.slab_mallocs;
+        out->live_nodes   += pool->_local_live - remote;
+    }
+    out->mallocs_avoided = out->node_allocs > out->slab_mallocs ?
+                           out->node_allocs - out->slab_mallocs : 0;
+}
+bool   handy_list_pool_trim     ()
+{
+    // slabs can only go back to the system once no node is in use, and
+    // then no other thread holds one to give back either
+    for( int i = 0; i < 2; i++ )
+    {
+        if( handy_pools[i] != NULL && handy_pool_live( handy_pools[i] ) != 0 )
+            return false;
+    }
+
+    for( int i = 0; i < 2; i++ )
+    {
+        _handy_pool pool = handy_pools[i];
+        if( pool == NULL )
+            continue;
+
+        while( pool->_slabs != NULL )
+        {
+            _handy_pool_slab next = pool->_slabs->_next;
+            free( pool->_slabs );
+            pool->_slabs = next;
+        }
+        pool->_free = NULL;
+        pool->_remote = NULL;
+        pool->_bump = pool->_slab_nodes;
+    }
+    return true;
+}
+
+enum { HANDY_LINK_FRONT, HANDY_LINK_BACK, HANDY_LINK_MIDDLE };
+
+// order-statistics index: an implicit treap over the nodes of an indexed
+// list. In-order position is list position and every tree node counts its
+// subtree, so a position is found in O(log n) expected. The tree is
+// updated from the node's list neighbours, never by position.
+
+static _Thread_local unsigned handy_tree_seed = 2463534242u;
+
+static unsigned handy_tree_prio         ()
+{
+    // xorshift32
+    handy_tree_seed ^= handy_tree_seed << 13;
+    handy_tree_seed ^= handy_tree_seed >> 17;
+    handy_tree_seed ^= handy_tree_seed << 5;
+    return handy_tree_seed;
+}
+static int  handy_tree_count            ( _handy_list_inode node )
+{
+    return node == NULL ? 0 : node->_count;
+}
+static void handy_tree_update           ( _handy_list_inode node )
+{
+    node->_count = 1 + handy_tree_count( node->_left ) + handy_tree_count( node->_right );
+}
+// lift node one level above its parent, keeping the in-order sequence
+static void handy_tree_rotate_up        ( handy_list self, _handy_list_inode node )
+{
+    _handy_list_inode parent = node->_parent;
+    _handy_list_inode grand  = parent->_parent;
+
+    if( parent->_left == node )
+    {
+        parent->_left = node->_right;
+        if( node->_right != NULL )
+            node->_right->_parent = parent;
+        node->_right = parent;
+    }
+    else
+    {
+        parent->_right = node->_left;
+        if( node->_left != NULL )
+            node->_left->_parent = parent;
+        node->_left = parent;
+    }
+    parent->_parent = node;
+    node->_parent = grand;
+
+    if( grand == NULL )
+        self->_root = node;
+    else if( grand->_left == parent )
+        grand->_left = node;
+    else
+        grand->_right = node;
+
+    handy_tree_update( parent );
+    handy_tree_update( node );
+}
+// node is already linked into the list; give it the matching tree slot
+static void handy_tree_insert           ( handy_list self, _handy_list_inode node )
+{
+    _handy_list_inode at;
+
+    node->_left = node->_right = NULL;
+    node->_count = 1;
+    node->_prio = handy_tree_prio();
+
+    if( self->_root == NULL )
+    {
+        node->_parent = NULL;
+        self->_root = node;
+        return;
+    }
+
+    if( node->_obj._prev != NULL )
+    {
+        // right after its predecessor in in-order
+        at = (_handy_list_inode) node->_obj._prev;
+        if( at->_right == NULL )
+            at->_right = node;
+        else
+        {
+            for( at = at->_right; at->_left != NULL; at = at->_left )
+                ;
+            at->_left = node;
+        }
+    }
+    else
+    {
+        // new leftmost
+        for( at = self->_root; at->_left != NULL; at = at->_left )
+            ;
+        at->_left = node;
+    }
+    node->_parent = at;
+
+    for( ; at != NULL; at = at->_parent )
+        at->_count++;
+
+    while( node->_parent != NULL && node->_parent->_prio < node->_prio )
+        handy_tree_rotate_up( self, node );
+}
+static void handy_tree_remove           ( handy_list self, _handy_list_inode node )
+{
+    // sink the node to a leaf, then cut it off
+    while( node->_left != NULL || node->_right != NULL )
+    {
+        if( node->_left == NULL )
+            handy_tree_rotate_up( self, node->_right );
+        else if( node->_right == NULL )
+            handy_tree_rotate_up( self, node->_left );
+        else if( node->_left->_prio > node->_right->_prio )
+            handy_tree_rotate_up( self, node->_left );
+        else
+            handy_tree_rotate_up( self, node->_right );
+    }
+
+    _handy_list_inode parent = node->_parent;
+
+    if( parent == NULL )
+        self->_root = NULL;
+    else if( parent->_left == node )
+        parent->_left = NULL;
+    else
+        parent->_right = NULL;
+
+    for( ; parent != NULL; parent = parent->_parent )
+        parent->_count--;
+}
+// join two treaps, every node of a before every node of b
+static _handy_list_inode handy_tree_merge ( _handy_list_inode a, _handy_list_inode b )
+{
+    if( a == NULL )
+        return b;
+    if( b == NULL )
+        return a;
+
+    if( a->_prio > b->_prio )
+    {
+        a->_right = handy_tree_merge( a->_right, b );
+        a->_right->_parent = a;
+        handy_tree_update( a );
+        return a;
+    }
+    b->_left = handy_tree_merge( a, b->_left );
+    b->_left->_parent = b;
+    handy_tree_update( b );
+    return b;
+}
+// cut a treap into its first count nodes and the rest
+static void handy_tree_split            ( _handy_list_inode node, int count,
+                                          _handy_list_inode * left, _handy_list_inode * right )
+{
+    if( node == NULL )
+    {
+        *left = *right = NULL;
+        return;
+    }
+
+    if( handy_tree_count( node->_left ) < count )
+    {
+        handy_tree_split( node->_right, count - handy_tree_count( node->_left ) - 1, &node->_right, right );
+        if( node->_right != NULL )
+            node->_right->_parent = node;
+        *left = node;
+    }
+    else
+    {
+        handy_tree_split( node->_left, count, left, &node->_left );
+        if( node->_left != NULL )
+            node->_left->_parent = node;
+        *right = node;
+    }
+    handy_tree_update( node );
+}
+static _handy_list_obj handy_tree_at    ( handy_list self, int at )
+{
+    _handy_list_inode iter = self->_root;
+
+    while( iter != NULL )
+    {
+        int left = handy_tree_count( iter->_left );
+
+        HANDY_STAT( self, hops, 1 );
+
+        if( at < left )
+            iter = iter->_left;
+        else if( at == left )
+            return &iter->_obj;
+        else
+        {
+            at -= left + 1;
+            iter = iter->_right;
+        }
+    }
+    return NULL;
+}
+// position of node, from the subtree counts on its way up to the root
+static int  handy_tree_rank             ( _handy_list_inode node )
+{
+    int rank = handy_tree_count( node->_left );
+
+    for( ; node->_parent != NULL; node = node->_parent )
+    {
+        if( node == node->_parent->_right )
+            rank += handy_tree_count( node->_parent->_left ) + 1;
+    }
+    return rank;
+}
+
+// rebuild the treap over the new order in O(n): a Cartesian tree on the
+// priorities the nodes already have, grown along its right spine
+static void handy_tree_rebuild          ( handy_list self )
+{
+    _handy_list_inode spine = NULL;
+
+    self->_root = NULL;
+
+    for( _handy_list_obj iter = self->_first; iter != NULL; iter = iter->_next )
+    {
+        _handy_list_inode node = (_handy_list_inode) iter;
+        _handy_list_inode below = NULL;
+
+        // whatever leaves the spine is complete and can be counted
+        while( spine != NULL && spine->_prio < node->_prio )
+        {
+            handy_tree_update( spine );
+            below = spine;
+            spine = spine->_parent;
+        }
+
+        node->_left = below;
+        node->_right = NULL;
+        if( below != NULL )
+            below->_parent = node;
+
+        node->_parent = spine;
+        if( spine != NULL )
+            spine->_right = node;
+        else
+            self->_root = node;
+
+        spine = node;
+    }
+    for( ; spine != NULL; spine = spine->_parent )
+        handy_tree_update( spine );
+}
+
+// membership index: open addressing with linear probing from item to
+// node, one entry per node. Each entry carries a stamp, its position plus
+// an offset, so contain answers with an index without walking the list.
+// Stamps stay exact while the list only changes at its ends; a change in
+// the middle marks them stale until handy_list_index_refresh renumbers.
+// contain never writes: with stale stamps it takes the position from the
+// order-statistics index in O(log n) if the list has one, and otherwise
+// walks from the node found to the nearer end, at most n / 2 nodes.
+
+struct __handy_hash_entry
+{
+    void *          _key;
+    _handy_list_obj _node;          // NULL marks a free slot
+    long long       _stamp;
+};
+
+struct __handy_list_hash
+{
+    size_t    _mask;
+    size_t    _used;
+    long long _lo;                  // stamp of the front node
+    long long _hi;                  // stamp one past the back node
+    bool      _dense;               // stamps match positions
+
+    struct __handy_hash_entry * _entries;
+};
+
+#define HANDY_HASH_MIN_SLOTS 16
+
+static size_t handy_hash_slot           ( struct __handy_list_hash * hash, void * key )
+{
+    // 64-bit finaliser from MurmurHash3
+    unsigned long long x = (unsigned long long)(uintptr_t) key;
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+
+    return (size_t) x & hash->_mask;
+}
+static void handy_hash_put              ( struct __handy_list_hash * hash, _handy_list_obj node, long long stamp )
+{
+    size_t i = handy_hash_slot( hash, node->_data );
+
+    while( hash->_entries[i]._node != NULL )
+        i = ( i + 1 ) & hash->_mask;
+
+    hash->_entries[i]._key = node->_data;
+    hash->_entries[i]._node = node;
+    hash->_entries[i]._stamp = stamp;
+    hash->_used++;
+}
+static bool handy_hash_resize           ( struct __handy_list_hash * hash, size_t slots )
+{
+    struct __handy_hash_entry * old = hash->_entries;
+    size_t                      old_slots = old != NULL ? hash->_mask + 1 : 0;
+
+    hash->_entries = calloc( slots, sizeof( *hash->_entries ) );
+    if( hash->_entries == NULL )
+    {
+        hash->_entries = old;
+        return false;
+    }
+    hash->_mask = slots - 1;
+    hash->_used = 0;
+
+    for( size_t i = 0; i < old_slots; i++ )
+    {
+        if( old[i]._node != NULL )
+            handy_hash_put( hash, old[i]._node, old[i]._stamp );
+    }
+    free( old );
+    return true;
+}
+// make room for count more nodes before any of them is linked, so that
+// running out of memory leaves the list and its index as they were
+static bool handy_hash_reserve          ( handy_list self, int count )
+{
+    struct __handy_list_hash * hash = self->_hash;
+
+    if( hash == NULL )
+    {
+        hash = calloc( 1, sizeof( *hash ) );
+        if( hash == NULL || !handy_hash_resize( hash, HANDY_HASH_MIN_SLOTS ) )
+        {
+            free( hash );
+            return false;
+        }
+        hash->_dense = true;
+        self->_hash = hash;
+    }
+
+    // keep the load under 0.7
+    size_t slots = hash->_mask + 1;
+
+    while( ( hash->_used + (size_t) count ) * 10 > slots * 7 )
+        slots *= 2;
+
+    return slots == hash->_mask + 1 || handy_hash_resize( hash, slots );
+}
+// the room was reserved with handy_hash_reserve
+static void handy_hash_link             ( handy_list self, _handy_list_obj node, int where )
+{
+    struct __handy_list_hash * hash = self->_hash;
+
+    if( self->_size == 0 )
+    {
+        hash->_lo = hash->_hi = 0;
+        hash->_dense = true;
+    }
+
+    if( where == HANDY_LINK_FRONT )
+        handy_hash_put( hash, node, --hash->_lo );
+    else if( where == HANDY_LINK_BACK )
+        handy_hash_put( hash, node, hash->_hi++ );
+    else
+    {
+        handy_hash_put( hash, node, 0 );
+        hash->_dense = false;
+    }
+}
+static void handy_hash_unlink           ( handy_list self, _handy_list_obj node, int where )
+{
+    struct __handy_list_hash * hash = self->_hash;
+    size_t                     i = handy_hash_slot( hash, node->_data );
+
+    while( hash->_entries[i]._node != node )
+        i = ( i + 1 ) & hash->_mask;
+
+    // backward-shift deletion: pull later entries of the run into the hole
+    for( size_t j = ( i + 1 ) & hash->_mask; hash->_entries[j]._node != NULL; j = ( j + 1 ) & hash->_mask )
+    {
+        size_t home = handy_hash_slot( hash, hash->_entries[j]._key );
+
+        if( ( ( j - home ) & hash->_mask ) >= ( ( j - i ) & hash->_mask ) )
+        {
+            hash->_entries[i] = hash->_entries[j];
+            i = j;
+        }
+    }
+    hash->_entries[i]._node = NULL;
+    hash->_used--;
+
+    if( where == HANDY_LINK_FRONT )
+        hash->_lo++;
+    else if( where == HANDY_LINK_BACK )
+        hash->_hi--;
+    else
+        hash->_dense = false;
+}
+static struct __handy_hash_entry * handy_hash_find ( struct __handy_list_hash * hash, _handy_list_obj node )
+{
+    size_t i = handy_hash_slot( hash, node->_data );
+
+    while( hash->_entries[i]._node != node )
+        i = ( i + 1 ) & hash->_mask;
+
+    return &hash->_entries[i];
+}
+static void handy_hash_release          ( handy_list self )
+{
+    if( self->_hash != NULL )
+    {
+        free( self->_hash->_entries );
+        self->_hash = ( free( self->_hash ), NULL );
+    }
+}
+static void handy_hash_renumber         ( handy_list self )
+{
+    struct __handy_list_hash * hash = self->_hash;
+    _handy_list_obj            iter = self->_first;
+
+    for( int i = 0; i < self->_size; i++, iter = iter->_next )
+        handy_hash_find( hash, iter )->_stamp = i;
+
+    hash->_lo = 0;
+    hash->_hi = self->_size;
+    hash->_dense = true;
+}
+// physical position of node without the stamps
+static int  handy_hash_locate           ( handy_list self, _handy_list_obj node )
+{
+    if( self->_flags & HANDY_LIST_INDEXED )
+        return handy_tree_rank( (_handy_list_inode) node );
+
+    // step out both ways until one side runs off its end
+    _handy_list_obj back = node, ahead = node;
+
+    for( int steps = 0; ; steps++, back = back->_prev, ahead = ahead->_next )
+    {
+        HANDY_STAT( self, hops, 1 );
+
+        if( back->_prev == NULL )
+            return steps;
+        if( ahead->_next == NULL )
+            return self->_size - 1 - steps;
+    }
+}
+static int  handy_hash_contain          ( handy_list self, void * item )
+{
+    struct __handy_list_hash * hash = self->_hash;
+
+    if( hash == NULL || self->_size == 0 )
+        return -1;
+
+    // duplicates share the probe run: report the earliest one, which is
+    // the physically last one in a reversed list
+    long long best = -1;
+
+    for( size_t i = handy_hash_slot( hash, item ); hash->_entries[i]._node != NULL; i = ( i + 1 ) & hash->_mask )
+    {
+        if( hash->_entries[i]._key != item )
+            continue;
+
+        long long at = hash->_dense ? hash->_entries[i]._stamp - hash->_lo
+                                    : handy_hash_locate( self, hash->_entries[i]._node );
+
+        if( self->_reversed )
+            at = self->_size - 1 - at;
+
+        if( best < 0 || at < best )
+            best = at;
+    }
+    return (int) best;
+}
+
+// side indexes follow every node linked into or cut out of the list;
+// where says whether that happened at the front, the back or in between
+
+static void handy_index_link            ( handy_list self, _handy_list_obj node, int where )
+{
+    if( self->_flags & HANDY_LIST_INDEXED )
+        handy_tree_insert( self, (_handy_list_inode) node );
+    if( self->_flags & HANDY_LIST_HASHED )
+        handy_hash_link( self, node, where );
+}
+static void handy_index_unlink          ( handy_list self, _handy_list_obj node, int where )
+{
+    if( self->_flags & HANDY_LIST_INDEXED )
+        handy_tree_remove( self, (_handy_list_inode) node );
+    if( self->_flags & HANDY_LIST_HASHED )
+        handy_hash_unlink( self, node, where );
+}
+void   handy_list_index_refresh ( handy_list self )
+{
+    if( self->_hash != NULL && !self->_hash->_dense )
+        handy_hash_renumber( self );
+}
+size_t handy_list_index_bytes   ( handy_list self )
+{
+    size_t bytes = 0;
+
+    // other kinds may keep flags for later, but index nothing
+    if( self->_ops != &handy_node_list_ops )
+        return 0;
+
+    if( self->_flags & HANDY_LIST_INDEXED )
+        bytes += (size_t) self->_size * ( sizeof( struct __handy_list_inode ) - sizeof( struct __handy_list_obj ) );
+
+    if( self->_hash != NULL )
+        bytes += sizeof( *self->_hash ) + ( self->_hash->_mask + 1 ) * sizeof( *self->_hash->_entries );
+
+    return bytes;
+}
+
+// one table shared by every node list
+const struct _handy_list_ops handy_node_list_ops =
+{
+    .contain       = handy_node_list_contain,
+    .add_front     = handy_node_list_add_front,
+    .add_back      = handy_node_list_add_back,
+    .add_at        = handy_node_list_add_at,
+    .empty         = handy_node_list_empty,
+    .get_front     = handy_node_list_get_front,
+    .get_back      = handy_node_list_get_back,
+    .get_at        = handy_node_list_get_at,
+    .rem_front     = handy_node_list_rem_front,
+    .rem_back      = handy_node_list_rem_back,
+    .reverse       = handy_node_list_reverse,
+    .rem_at        = handy_node_list_rem_at,
+    .free          = handy_node_list_free,
+    .length        = handy_node_list_length,
+};
+
+void   handy_list_init_header   ( handy_list self, const struct _handy_list_ops * ops )
+{
+    self->_ops = ops;
+
+    self->_first = self->_last = NULL;
+    self->_size = 0;
+    self->_reversed = false;
+    self->_flags = 0;
+    self->_root = NULL;
+    self->_hash = NULL;
+    self->_pool = NULL;
+
+#ifdef HANDY_LIST_STATS
+    memset( &self->_stats, 0, sizeof( self->_stats ) );
+#endif
+
+#ifdef HANDY_LIST_LEGACY_VTABLE
+    self->contain       = ops->contain;
+    self->add_front     = ops->add_front;
+    self->add_back      = ops->add_back;
+    self->add_at        = ops->add_at;
+    self->empty         = ops->empty;
+    self->get_front     = ops->get_front;
+    self->get_back      = ops->get_back;
+    self->get_at        = ops->get_at;
+    self->rem_front     = ops->rem_front;
+    self->rem_back      = ops->rem_back;
+    self->reverse       = ops->reverse;
+    self->rem_at        = ops->rem_at;
+    self->free          = ops->free;
+    self->length        = ops->length;
+#endif
+}
 handy_list handy_create_list    ()
 {
-    handy_list  temp_list = malloc( sizeof(*temp_list) );
+    return handy_create_list_with( 0 );
+}
+handy_list handy_create_list_with ( unsigned flags )
+{
+    handy_list  temp_list = malloc( sizeof(*temp_list) );
+    if( temp_list == NULL )
+        return NULL;
+
+    handy_list_init_header( temp_list, &handy_node_list_ops );
+    temp_list->_flags = flags;
+
+    return temp_list;
+}
+int   handy_node_list_contain       ( handy_list self, void * item )
+{
+    if( self->_flags & HANDY_LIST_HASHED )
+        return handy_hash_contain( self, item );
+
+    _handy_list_obj iter = self->_reversed ? self->_last : self->_first;
+    for( int i = 0; i < self->_size; i++ )
+    {
+        if( memcmp( &(iter->_data), &item, sizeof(iter->_data) ) == 0 )
+        {
+            HANDY_STAT( self, hops, i );
+            return i;
+        }
+        iter = self->_reversed ? iter->_prev : iter->_next;
+    }
+    HANDY_STAT( self, hops, self->_size );
+    return -1;
+}
+static bool   handy_node_add_front   ( handy_list self, void * item )
+{
+    if( self->_size == 0 )
+    {
+        _handy_list_obj temp = handy_node_alloc( self, item );
+        if( temp == NULL )
+            return false;
+
+        self->_last  = self->_first = temp;
+
+        if( self->_flags )
+            handy_index_link( self, temp, HANDY_LINK_FRONT );
+
+        self->_size++;
+
+        return true;
+    }
+    else if ( self->_size > 0 )
+    {
+        _handy_list_obj temp = handy_node_alloc( self, item );
+        if( temp == NULL )
+            return false;
+
+        temp->_next = self->_first;
+
+        self->_first->_prev = temp;
+        self->_first = temp;
+
+        if( self->_flags )
+            handy_index_link( self, temp, HANDY_LINK_FRONT );
+
+        self->_size++;
+
+        return true;
+    }
+    return false;
+}
+static bool   handy_node_add_back    ( handy_list self, void * item )
+{
+    if( self->_size == 0 )
+    {
+        _handy_list_obj temp = handy_node_alloc( self, item );
+        if( temp == NULL )
+            return false;
+
+        self->_last  = self->_first = temp;
+
+        if( self->_flags )
+            handy_index_link( self, temp, HANDY_LINK_BACK );
+
+        self->_size++;
+
+        return true;
+    }
+    else if ( self->_size > 0 )
+    {
+        _handy_list_obj temp = handy_node_alloc( self, item );
+        if( temp == NULL )
+            return false;
+
+        temp->_prev = self->_last;
+        self->_last->_next = temp;
+
+        self->_last = temp;
+
+        if( self->_flags )
+            handy_index_link( self, temp, HANDY_LINK_BACK );
+
+        self->_size++;
+
+        return true;
+    }
+    return false;
+}
+static bool   handy_node_add_at      ( handy_list self, void * item, int at )
+{
+    if( at <= 0 )
+        return handy_node_add_front( self, item );
+    else if( at >= self->_size )
+        return handy_node_add_back( self, item );
+    else
+    {
+        _handy_list_obj iter;
+        iter = self->_first;
+
+        _handy_list_obj temp = handy_node_alloc( self, item );
+        if( temp == NULL )
+            return false;
+
+        if( self->_flags & HANDY_LIST_INDEXED )
+            iter = handy_tree_at( self, at - 1 );
+        else
+            HANDY_STAT( self, hops, at - 1 );
+
+        for( int i = ( self->_flags & HANDY_LIST_INDEXED ) ? at : 1; i < self->_size; i++ )
+        {
+            if( i == at )
+            {
+                // handy_obj nodePrev = iter->_prev;
+                _handy_list_obj nextNode = iter->_next;
+
+                iter->_next = temp;
+                nextNode->_prev = temp;
+
+                temp->_prev = iter;
+                temp->_next = nextNode;
+
+                if( self->_flags )
+                    handy_index_link( self, temp, HANDY_LINK_MIDDLE );
+
+                self->_size++;
+                return true;
+
+            }
+            iter = iter->_next;
+        }
+    }
+    return false;
+}
+bool   handy_node_list_empty         ( handy_list self )
+{
+    return self->_size == 0 ? true : false;
+}
+void * handy_node_list_get_front     ( handy_list self )
+{
+    if( self->_size == 0 )
+    {
+        return NULL;
+    }
+    else if( self->_size > 0 )
+    {
+        return  self->_reversed ? self->_last->_data : self->_first->_data;
+    }
+    return NULL;
+}
+void * handy_node_list_get_back      ( handy_list self )
+{
+    if( self->_size == 0 )
+    {
+        return NULL;
+    }
+    else if( self->_size > 0 )
+    {
+        return  self->_reversed ? self->_first->_data : self->_last->_data;
+    }
+    return NULL;
+}
+static void * handy_node_get_at      ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size  )
+        return NULL;
+    else if( self->_flags & HANDY_LIST_INDEXED )
+        return handy_tree_at( self, at )->_data;
+    else
+    {
+        _handy_list_obj iter;
+        iter = self->_first;
+
+        HANDY_STAT( self, hops, at );
+
+        for( int i = 0; i < self->_size; i++ )
+        {
+            if( i == at )
+            {
+                if( i == 0 )
+                    return self->_first->_data;
+                else if( i == self->_size - 1 )
+                    return self->_last->_data;
+                else
+                    return iter->_data;
+            }
+            iter = iter->_next;
+        }
+    }
+    return NULL;
+}
+static bool   handy_node_rem_front   ( handy_list self )
+{
+    if( self->_size == 1 )
+    {
+        if( self->_flags )
+            handy_index_unlink( self, self->_first, HANDY_LINK_FRONT );
+
+        handy_node_free( self, self->_first );
+        self->_first = self->_last = NULL;
+        self->_size--;
+        return true;
+    }
+    else if( self->_size > 1 )
+    {
+        if( self->_flags )
+            handy_index_unlink( self, self->_first, HANDY_LINK_FRONT );
+
+        self->_first = self->_first->_next;
+
+        handy_node_free( self, self->_first->_prev );
+        self->_first->_prev = NULL;
+        self->_size--;
+        return true;
+    }
+    return false;
+}
+static bool   handy_node_rem_back    ( handy_list self )
+{
+
+    if( self->_size == 1 )
+    {
+        if( self->_flags )
+            handy_index_unlink( self, self->_first, HANDY_LINK_BACK );
+
+        handy_node_free( self, self->_first );
+        self->_first = self->_last = NULL;
+        self->_size--;
+
+        return true;
+    }
+    else if( self->_size > 1 )
+    {
+        if( self->_flags )
+            handy_index_unlink( self, self->_last, HANDY_LINK_BACK );
+
+        self->_last = self->_last->_prev;
+
+        self->_size--;
+
+        handy_node_free( self, self->_last->_next );
+        self->_last->_next = NULL;
+
+        return true;
+    }
+    return false;
+}
+static bool   handy_node_rem_at      ( handy_list self, int at )
+{
+    _handy_list_obj iter;
+    iter = self->_first;
+
+    if( at == 0 )
+        return handy_node_rem_front( self );
+    else if( at == self->_size - 1 )
+        return handy_node_rem_back( self );
+    else if( at > 0 && at < self->_size - 1 )
+    {
+        if( self->_flags & HANDY_LIST_INDEXED )
+            iter = handy_tree_at( self, at );
+        else
+            HANDY_STAT( self, hops, at );
+
+        for( int i = ( self->_flags & HANDY_LIST_INDEXED ) ? at : 0; i < self->_size; i++ )
+        {
+            if( i == at )
+            {
+                if( self->_flags )
+                    handy_index_unlink( self, iter, HANDY_LINK_MIDDLE );
+
+                iter->_prev->_next = iter->_next;
+                iter->_next->_prev = iter->_prev;
+                self->_size--;
+
+                iter = ( handy_node_free( self, iter ), NULL );
+                return true;
+            }
+            iter = iter->_next;
+        }
+    }
+
+    return false;
+}
+// the positional entry points: a reversed list is read from its physical
+// back, so logical position at is physical position size - 1 - at
+
+bool   handy_node_list_add_front     ( handy_list self, void * item )
+{
+    return self->_reversed ? handy_node_add_back( self, item ) : handy_node_add_front( self, item );
+}
+bool   handy_node_list_add_back      ( handy_list self, void * item )
+{
+    return self->_reversed ? handy_node_add_front( self, item ) : handy_node_add_back( self, item );
+}
+bool   handy_node_list_add_at        ( handy_list self, void * item, int at )
+{
+    if( !self->_reversed )
+        return handy_node_add_at( self, item, at );
+
+    // inserting before logical at is inserting after its physical node
+    if( at < 0 )
+        at = 0;
+    return handy_node_add_at( self, item, self->_size - at );
+}
+void * handy_node_list_get_at        ( handy_list self, int at )
+{
+    if( self->_reversed && at >= 0 && at < self->_size )
+        at = self->_size - 1 - at;
+    return handy_node_get_at( self, at );
+}
+bool   handy_node_list_rem_front     ( handy_list self )
+{
+    return self->_reversed ? handy_node_rem_back( self ) : handy_node_rem_front( self );
+}
+bool   handy_node_list_rem_back      ( handy_list self )
+{
+    return self->_reversed ? handy_node_rem_front( self ) : handy_node_rem_back( self );
+}
+bool   handy_node_list_rem_at        ( handy_list self, int at )
+{
+    if( self->_reversed && at >= 0 && at < self->_size )
+        at = self->_size - 1 - at;
+    return handy_node_rem_at( self, at );
+}
+void   handy_node_list_reverse       ( handy_list self )
+{
+    // O(1): only the reading direction changes, no node is touched
+    self->_reversed = !self->_reversed;
+}
+// turn the chain around and flip the flag: same reading order, opposite
+// physical order
+static void handy_list_turn             ( handy_list self )
+{
+    for( _handy_list_obj iter = self->_first; iter != NULL; iter = iter->_prev )
+    {
+        _handy_list_obj next = iter->_next;
+
+        iter->_next = iter->_prev;
+        iter->_prev = next;
+    }
+
+    _handy_list_obj first = self->_first;
+    self->_first = self->_last;
+    self->_last = first;
+    self->_reversed = !self->_reversed;
+
+    if( self->_flags & HANDY_LIST_INDEXED )
+        handy_tree_rebuild( self );
+
+    // the entries stay with their nodes; only the stamps run backwards
+    if( self->_hash != NULL )
+        self->_hash->_dense = false;
+}
+void   handy_list_normalize     ( handy_list self )
+{
+    if( self->_ops == &handy_node_list_ops && self->_reversed )
+        handy_list_turn( self );
+}
+void   handy_node_list_free          ( handy_list self )
+{
+    // the nodes are already chained through _next, so when they all came
+    // from one pool the whole list goes back in one step
+    if( self->_size > 0 )
+    {
+        HANDY_STAT( self, frees, self->_size );
+
+        if( self->_pool != HANDY_POOL_MIXED )
+            handy_pool_put_chain( self->_pool, self->_first, self->_last, self->_size );
+        else
+            handy_pool_put_mixed( self->_first, self->_size );
+    }
+
+    self->_first = self->_last = NULL;
+    self->_pool = NULL;
+    self->_root = NULL;
+    self->_size = 0;
+    self->_reversed = false;
+
+    handy_hash_release( self );
+}
+int    handy_node_list_length        ( handy_list self )
+{
+    return self->_size;
+}
+
+// cursors: a position held as a node pointer plus its index, so walking
+// is one pointer hop per step. Inserts and erases through the cursor go
+// through the same link/unlink paths as the positional operations. In a
+// reversed list a step forward follows _prev.
+
+static _handy_list_obj handy_list_step  ( handy_list self, _handy_list_obj node, bool forward )
+{
+    return forward != self->_reversed ? node->_next : node->_prev;
+}
+
+// link a node holding item in front of at ( at NULL: at the back )
+static _handy_list_obj handy_list_insert_before ( handy_list self, _handy_list_obj at, void * item )
+{
+    if( at == NULL )
+        return handy_node_add_back( self, item ) ? self->_last : NULL;
+    else if( at == self->_first )
+        return handy_node_add_front( self, item ) ? self->_first : NULL;
+
+    _handy_list_obj temp = handy_node_alloc( self, item );
+    if( temp == NULL )
+        return NULL;
+
+    temp->_prev = at->_prev;
+    temp->_next = at;
+    at->_prev->_next = temp;
+    at->_prev = temp;
+
+    if( self->_flags )
+        handy_index_link( self, temp, HANDY_LINK_MIDDLE );
+
+    self->_size++;
+    return temp;
+}
+static void handy_list_erase_node       ( handy_list self, _handy_list_obj node )
+{
+    if( node == self->_first )
+        handy_node_rem_front( self );
+    else if( node == self->_last )
+        handy_node_rem_back( self );
+    else
+    {
+        if( self->_flags )
+            handy_index_unlink( self, node, HANDY_LINK_MIDDLE );
+
+        node->_prev->_next = node->_next;
+        node->_next->_prev = node->_prev;
+        self->_size--;
+
+        handy_node_free( self, node );
+    }
+}
+void   handy_list_cursor_begin  ( handy_list self, handy_list_cursor * cursor )
+{
+    cursor->_list = self;
+    cursor->_node = self->_reversed ? self->_last : self->_first;
+    cursor->_index = 0;
+}
+void   handy_list_cursor_end    ( handy_list self, handy_list_cursor * cursor )
+{
+    cursor->_list = self;
+    cursor->_node = self->_reversed ? self->_first : self->_last;
+    cursor->_index = self->_size - 1;
+}
+bool   handy_list_cursor_valid  ( handy_list_cursor * cursor )
+{
+    return cursor->_node != NULL;
+}
+void * handy_list_cursor_get    ( handy_list_cursor * cursor )
+{
+    return cursor->_node != NULL ? cursor->_node->_data : NULL;
+}
+bool   handy_list_cursor_next   ( handy_list_cursor * cursor )
+{
+    if( cursor->_node == NULL )
+        return false;
+
+    cursor->_node = handy_list_step( cursor->_list, cursor->_node, true );
+    cursor->_index++;
+    return cursor->_node != NULL;
+}
+bool   handy_list_cursor_prev   ( handy_list_cursor * cursor )
+{
+    if( cursor->_node == NULL )
+        return false;
 
-    temp_list->_first = temp_list->_last = NULL;
-    temp_list->_size = 0;
-
-    temp_list->contain       = handy_list_contain;
-    temp_list->add_front     = handy_list_add_front;
-    temp_list->add_back      = handy_list_add_back;
-    temp_list->add_at        = handy_list_add_at;
-    temp_list->empty         = handy_list_empty;
-    temp_list->get_front     = handy_list_get_front;
-    temp_list->get_back      = handy_list_get_back;
-    temp_list->get_at        = handy_list_get_at;
-    temp_list->rem_front     = handy_list_rem_front;
-    temp_list->rem_back      = handy_list_rem_back;
-    temp_list->reverse       = handy_list_reverse;
-    temp_list->rem_at        = handy_list_rem_at;
-    temp_list->free          = handy_list_free;
-    temp_list->length        = handy_list_length;
+    cursor->_node = handy_list_step( cursor->_list, cursor->_node, false );
+    cursor->_index--;
+    return cursor->_node != NULL;
+}
+bool   handy_list_cursor_insert_before ( handy_list_cursor * cursor, void * item )
+{
+    handy_list      self = cursor->_list;
+    _handy_list_obj at = cursor->_node;
 
-    return temp_list;
+    // a cursor that ran off either end inserts at the back; reversed, the
+    // logical back is the physical front
+    if( self->_reversed )
+        at = at != NULL ? at->_next : self->_first;
+
+    if( handy_list_insert_before( self, at, item ) == NULL )
+        return false;
+
+    if( cursor->_node != NULL )
+        cursor->_index++;
+    else
+        cursor->_index = cursor->_list->_size;
+    return true;
 }
-int   handy_list_contain        ( handy_list self, void * item )
+bool   handy_list_cursor_erase  ( handy_list_cursor * cursor )
 {
-    _handy_list_obj iter = self->_first;
-    for( int i = 0; i < self->_size; i++ )
+    _handy_list_obj node = cursor->_node;
+
+    if( node == NULL )
+        return false;
+
+    // step onto the follower first so the cursor stays usable
+    cursor->_node = handy_list_step( cursor->_list, node, true );
+    handy_list_erase_node( cursor->_list, node );
+    return true;
+}
+void   handy_list_for_each      ( handy_list self, bool (*visit)( void * item, void * ctx ), void * ctx )
+{
+    _handy_list_obj iter = self->_reversed ? self->_last : self->_first;
+
+    for( ; iter != NULL; iter = handy_list_step( self, iter, true ) )
     {
-        if( memcmp( &(iter->_data), &item, sizeof(iter->_data) ) == 0 )
-            return i;
-        iter = iter->_next;
+        if( !visit( iter->_data, ctx ) )
+            return;
     }
-    return -1;
 }
-bool   handy_list_add_front     ( handy_list self, void * item )
+int    handy_list_remove_if     ( handy_list self, bool (*pred)( void * item, void * ctx ), void * ctx )
 {
-    if( self->_size == 0 )
+    int removed = 0;
+    handy_list_cursor cursor;
+
+    for( handy_list_cursor_begin( self, &cursor ); handy_list_cursor_valid( &cursor ); )
     {
-        _handy_list_obj temp = malloc( sizeof( *temp ) );
+        if( pred( handy_list_cursor_get( &cursor ), ctx ) )
+        {
+            handy_list_cursor_erase( &cursor );
+            removed++;
+        }
+        else
+            handy_list_cursor_next( &cursor );
+    }
+    return removed;
+}
 
-       	temp->_data = item;
+// bulk moves between lists: nodes are relinked, never copied. Both lists
+// must draw nodes from the same pool, i.e. agree on HANDY_LIST_INDEXED;
+// otherwise the items are copied over one by one.
 
-        self->_last  = self->_first = temp;
+static bool handy_list_same_nodes       ( handy_list self, handy_list other )
+{
+    return self->_ops == &handy_node_list_ops && other->_ops == &handy_node_list_ops &&
+           ( self->_flags & HANDY_LIST_INDEXED ) == ( other->_flags & HANDY_LIST_INDEXED );
+}
+// node at a valid position, walked from the nearer end unless indexed
+static _handy_list_obj handy_list_node_at ( handy_list self, int at )
+{
+    _handy_list_obj iter;
 
-        self->_size++;
+    if( self->_flags & HANDY_LIST_INDEXED )
+        return handy_tree_at( self, at );
 
-        return true;
+    if( at < self->_size / 2 )
+    {
+        HANDY_STAT( self, hops, at );
+        for( iter = self->_first; at > 0; at-- )
+            iter = iter->_next;
     }
-    else if ( self->_size > 0 )
+    else
     {
-        _handy_list_obj temp = malloc( sizeof( *temp ) );
-
-        temp->_data = item;
-        temp->_next = self->_first;
-
-        self->_first->_prev = temp;
-        self->_first = temp;
-        self->_size++;
-
-        return true;
+        HANDY_STAT( self, hops, self->_size - 1 - at );
+        for( iter = self->_last, at = self->_size - 1 - at; at > 0; at-- )
+            iter = iter->_prev;
     }
-    return false;
+    return iter;
 }
-bool   handy_list_add_back      ( handy_list self, void * item )
+bool   handy_list_splice        ( handy_list self, int at, handy_list other )
 {
-    if( self->_size == 0 )
-    {
-        _handy_list_obj temp = malloc( sizeof( * temp ) );
+    if( self == other || self->_ops != &handy_node_list_ops || other->_ops != &handy_node_list_ops )
+        return false;
+    if( other->_size == 0 )
+        return true;
 
-        temp->_data = item;
+    if( at < 0 )
+        at = 0;
+    else if( at > self->_size )
+        at = self->_size;
 
-        self->_last  = self->_first = temp;
+    if( !handy_list_same_nodes( self, other ) )
+    {
+        // nodes of the other size: copy into a list like self first, so
+        // that running out of memory leaves both lists as they were
+        handy_list temp = handy_create_list_with( self->_flags );
+        if( temp == NULL )
+            return false;
 
-        self->_size++;
+        for( _handy_list_obj iter = other->_reversed ? other->_last : other->_first; iter != NULL;
+             iter = other->_reversed ? iter->_prev : iter->_next )
+        {
+            if( !handy_node_list_add_back( temp, iter->_data ) )
+            {
+                handy_list_free( temp );
+                free( temp );
+                return false;
+            }
+        }
 
+        handy_list_splice( self, at, temp );
+        free( temp );
+        handy_list_free( other );
         return true;
     }
-    else if ( self->_size > 0 )
-    {
-        _handy_list_obj temp = malloc( sizeof( * temp ) );
 
-        temp->_data = item;
+    if( ( self->_flags & HANDY_LIST_HASHED ) && !handy_hash_reserve( self, other->_size ) )
+        return false;
 
-        temp->_prev = self->_last;
-        self->_last->_next = temp;
+    // bring other round to the same direction, then work on physical order
+    if( other->_reversed != self->_reversed )
+        handy_list_turn( other );
+    if( self->_reversed )
+        at = self->_size - at;
 
-        self->_last = temp;
-        self->_size++;
+    _handy_list_obj after  = at == self->_size ? NULL : handy_list_node_at( self, at );
+    _handy_list_obj before = after != NULL ? after->_prev : self->_last;
+    _handy_list_obj first  = other->_first;
+    _handy_list_obj last   = other->_last;
+    int             count  = other->_size;
 
-        return true;
-    }
-    return false;
-}
-bool   handy_list_add_at        ( handy_list self, void *item, int at )
-{
-    if( at <= 0 )
-        return (self->add_front(self, item));
-    else if( at >= self->_size )
-        return ( self->add_back(self, item) );
-    else
+    if( self->_flags & HANDY_LIST_INDEXED )
     {
-        _handy_list_obj iter;
-        iter = self->_first;
+        _handy_list_inode left, right;
 
-        _handy_list_obj temp = malloc( sizeof( * temp ) );
-        temp->_data = item;
+        handy_tree_split( self->_root, at, &left, &right );
+        self->_root = handy_tree_merge( handy_tree_merge( left, other->_root ), right );
+        self->_root->_parent = NULL;
+    }
 
-        for( int i = 1; i < self->_size; i++ )
-        {
-            if( i == at )
-            {
-                // handy_obj nodePrev = iter->_prev;
-                _handy_list_obj nextNode = iter->_next;
+    first->_prev = before;
+    last->_next = after;
 
-                iter->_next = temp;
-                nextNode->_prev = temp;
+    if( before != NULL )
+        before->_next = first;
+    else
+        self->_first = first;
 
-                temp->_prev = iter;
-                temp->_next = nextNode;
+    if( after != NULL )
+        after->_prev = last;
+    else
+        self->_last = last;
 
-                self->_size++;
-                return true;
+    handy_pool_note( self, other->_pool );
 
-            }
-            iter = iter->_next;
+    handy_hash_release( other );
+    other->_first = other->_last = NULL;
+    other->_root = NULL;
+    other->_pool = NULL;
+    other->_size = 0;
+
+    if( self->_flags & HANDY_LIST_HASHED )
+    {
+        // the hash index is per node; keep stamps exact at the ends
+        if( after == NULL )
+        {
+            for( _handy_list_obj iter = first; iter != after; iter = iter->_next, self->_size++ )
+                handy_hash_link( self, iter, HANDY_LINK_BACK );
+        }
+        else if( before == NULL )
+        {
+            for( _handy_list_obj iter = last; iter != NULL; iter = iter->_prev, self->_size++ )
+                handy_hash_link( self, iter, HANDY_LINK_FRONT );
+        }
+        else
+        {
+            for( _handy_list_obj iter = first; iter != after; iter = iter->_next, self->_size++ )
+                handy_hash_link( self, iter, HANDY_LINK_MIDDLE );
         }
     }
-    return false;
+    else
+        self->_size += count;
+
+    return true;
 }
-bool   handy_list_empty         ( handy_list self )
+bool   handy_list_concat        ( handy_list self, handy_list other )
 {
-    return self->_size == 0 ? true : false;
+    return handy_list_splice( self, self->_size, other );
 }
-void * handy_list_get_front     ( handy_list self )
+// cut physical positions at .. end of self into the empty list tail; false,
+// changing nothing, when tail cannot index them
+static bool handy_list_split_nodes      ( handy_list self, handy_list tail, int at )
 {
-    if( self->_size == 0 )
+    if( ( tail->_flags & HANDY_LIST_HASHED ) && !handy_hash_reserve( tail, self->_size - at ) )
+        return false;
+
+    _handy_list_obj node = handy_list_node_at( self, at );
+    _handy_list_obj last = self->_last;
+
+    if( self->_flags & HANDY_LIST_INDEXED )
     {
-        return NULL;
+        handy_tree_split( self->_root, at, &self->_root, &tail->_root );
+        if( self->_root != NULL )
+            self->_root->_parent = NULL;
+        tail->_root->_parent = NULL;
     }
-    else if( self->_size > 0 )
+
+    if( self->_flags & HANDY_LIST_HASHED )
     {
-        return  self->_first->_data;
+        for( _handy_list_obj iter = last; iter != node->_prev; iter = iter->_prev )
+            handy_hash_unlink( self, iter, HANDY_LINK_BACK );
+        for( _handy_list_obj iter = node; iter != NULL; iter = iter->_next, tail->_size++ )
+            handy_hash_link( tail, iter, HANDY_LINK_BACK );
     }
-    return NULL;
+
+    if( node->_prev != NULL )
+    {
+        self->_last = node->_prev;
+        self->_last->_next = NULL;
+    }
+    else
+        self->_first = self->_last = NULL;
+
+    node->_prev = NULL;
+
+    tail->_first = node;
+    tail->_last = last;
+    tail->_pool = self->_pool;
+    tail->_size = self->_size - at;
+    self->_size = at;
+    return true;
 }
-void * handy_list_get_back      ( handy_list self )
+handy_list handy_list_split_at  ( handy_list self, int at )
 {
-    if( self->_size == 0 )
-    {
+    if( self->_ops != &handy_node_list_ops )
         return NULL;
-    }
-    else if( self->_size > 0 )
+
+    handy_list tail = handy_create_list_with( self->_flags );
+    if( tail == NULL )
+        return NULL;
+
+    if( at < 0 )
+        at = 0;
+    if( at >= self->_size )
+        return tail;
+
+    // the logical tail of a reversed list is its physical front: cut there
+    // and trade the two halves
+    if( self->_reversed )
+        at = self->_size - at;
+
+    if( at < self->_size && !handy_list_split_nodes( self, tail, at ) )
     {
-        return  self->_last->_data;
+        handy_list_free( tail );
+        free( tail );
+        return NULL;
     }
-    return NULL;
+    if( !self->_reversed )
+        return tail;
+
+    struct _handy_list_struct hold = *self;
+
+    self->_first = tail->_first;
+    self->_last = tail->_last;
+    self->_size = tail->_size;
+    self->_root = tail->_root;
+    self->_hash = tail->_hash;
+    self->_pool = tail->_pool;
+
+    tail->_first = hold._first;
+    tail->_last = hold._last;
+    tail->_size = hold._size;
+    tail->_root = hold._root;
+    tail->_hash = hold._hash;
+    tail->_pool = hold._pool;
+    tail->_reversed = true;
+
+    return tail;
 }
-void * handy_list_get_at        ( handy_list self, int at )
+bool   handy_list_add_back_n    ( handy_list self, void ** items, int count )
 {
-    if( at < 0 || at >= self->_size  )
-        return NULL;
-    else
+    if( self->_ops != &handy_node_list_ops )
+        return false;
+    if( count <= 0 )
+        return true;
+    if( ( self->_flags & HANDY_LIST_HASHED ) && !handy_hash_reserve( self, count ) )
+        return false;
+
+    _handy_pool pool  = handy_pool_of( self );
+    int         added = 0;
+
+    while( added < count )
     {
-        _handy_list_obj iter;
-        iter = self->_first;
+        int    got;
+        char * block = handy_pool_get_block( pool, count - added, &got );
+        if( block == NULL )
+        {
+            // all or nothing
+            while( added-- > 0 )
+                handy_node_list_rem_back( self );
+            return false;
+        }
 
-        for( int i = 0; i < self->_size; i++ )
+        HANDY_STAT( self, allocs, got );
+        handy_pool_note( self, pool );
+
+        for( int i = 0; i < got; i++, added++ )
         {
-            if( i == at )
+            _handy_list_obj temp = (_handy_list_obj)( block + pool->_node_size * i );
+
+            temp->_data = items[ added ];
+
+            // the logical back of a reversed list is its physical front
+            if( !self->_reversed )
             {
-                if( i == 0 )
-                    return (self->get_front(self) );
-                else if( i == self->_size - 1 )
-                    return (self->get_back(self) );
+                temp->_prev = self->_last;
+                temp->_next = NULL;
+
+                if( self->_last != NULL )
+                    self->_last->_next = temp;
                 else
-                    return iter->_data;
+                    self->_first = temp;
+                self->_last = temp;
             }
-            iter = iter->_next;
+            else
+            {
+                temp->_prev = NULL;
+                temp->_next = self->_first;
+
+                if( self->_first != NULL )
+                    self->_first->_prev = temp;
+                else
+                    self->_last = temp;
+                self->_first = temp;
+            }
+
+            if( self->_flags )
+                handy_index_link( self, temp, self->_reversed ? HANDY_LINK_FRONT : HANDY_LINK_BACK );
+
+            self->_size++;
         }
     }
-    return NULL;
+    return true;
 }
-bool  handy_list_rem_front      ( handy_list self )
+
+// sorting: bottom-up merge sort over the _next chain. Runs of 1, 2, 4 ..
+// nodes wait in bins, lower bins holding later nodes, so every merge
+// takes the earlier run as its left side and equal items keep their
+// order. The bins live on the stack; nothing is allocated.
+
+#define HANDY_SORT_BINS         64
+#define HANDY_SORT_MAX_THREADS  64
+
+typedef int (*_handy_list_compare)( void * a, void * b, void * ctx );
+
+// merge two sorted chains ending in NULL, a before b on ties
+static _handy_list_obj handy_sort_merge ( _handy_list_obj a, _handy_list_obj b,
+                                          _handy_list_compare compare, void * ctx )
 {
-    if( self->_size == 1 )
+    struct __handy_list_obj head;
+    _handy_list_obj         tail = &head;
+
+    while( a != NULL && b != NULL )
     {
-        self->_first = ( free( self->_first ), NULL );
-        self->_first = self->_last = NULL;
-        self->_size--;
-        return true;
+        if( compare( b->_data, a->_data, ctx ) < 0 )
+        {
+            tail->_next = b;
+            b = b->_next;
+        }
+        else
+        {
+            tail->_next = a;
+            a = a->_next;
+        }
+        tail = tail->_next;
     }
-    else if( self->_size > 1 )
+    tail->_next = a != NULL ? a : b;
+
+    return head._next;
+}
+static _handy_list_obj handy_sort_chain ( _handy_list_obj first, _handy_list_compare compare, void * ctx )
+{
+    _handy_list_obj bins[ HANDY_SORT_BINS ] = { NULL };
+    int             used = 0;
+
+    while( first != NULL )
     {
-        self->_first = self->_first->_next;
+        _handy_list_obj run = first;
+        int             i;
 
-        self->_first->_prev = ( free(self->_first->_prev), NULL );
-        self->_size--;
-        return true;
+        first = first->_next;
+        run->_next = NULL;
+
+        for( i = 0; i < used && bins[i] != NULL; i++ )
+        {
+            run = handy_sort_merge( bins[i], run, compare, ctx );
+            bins[i] = NULL;
+        }
+        if( i == used )
+            used++;
+        bins[i] = run;
     }
-    return false;
+
+    _handy_list_obj sorted = NULL;
+
+    for( int i = 0; i < used; i++ )
+    {
+        if( bins[i] != NULL )
+            sorted = handy_sort_merge( bins[i], sorted, compare, ctx );
+    }
+    return sorted;
 }
-bool  handy_list_rem_back       ( handy_list self )
+// take a sorted chain as the new node order of self
+static void handy_sort_relink           ( handy_list self, _handy_list_obj first )
 {
+    _handy_list_obj prev = NULL;
 
-    if( self->_size == 1 )
-    {
-        self->_first = ( free(self->_first), NULL );
-        self->_first = self->_last = NULL;
-        self->_size--;
+    self->_first = first;
 
-        return true;
+    for( _handy_list_obj iter = first; iter != NULL; iter = iter->_next )
+    {
+        iter->_prev = prev;
+        prev = iter;
     }
-    else if( self->_size > 1 )
+    self->_last = prev;
+
+    if( self->_flags & HANDY_LIST_INDEXED )
+        handy_tree_rebuild( self );
+
+    // entries belong to nodes and stay valid; only the stamps are stale
+    if( self->_hash != NULL )
+        self->_hash->_dense = false;
+}
+bool   handy_list_sort          ( handy_list self, int (*compare)( void * a, void * b, void * ctx ), void * ctx )
+{
+    if( self->_ops != &handy_node_list_ops )
+        return false;
+
+    if( self->_size > 1 )
     {
-        self->_last = self->_last->_prev;
+        handy_list_normalize( self );
 
-        self->_size--;
+        self->_last->_next = NULL;
+        handy_sort_relink( self, handy_sort_chain( self->_first, compare, ctx ) );
+    }
+    return true;
+}
 
-        self->_last->_next = ( free(self->_last->_next), NULL );
+// parallel sort: the chain is cut into one piece per thread, the pieces
+// are sorted side by side and then merged pairwise, again side by side,
+// until one chain is left
 
-        return true;
+struct __handy_sort_task
+{
+    _handy_list_obj     _first;
+    _handy_list_obj     _second;    // NULL: sort _first, else merge the two
+    _handy_list_compare _compare;
+    void *              _ctx;
+};
+
+static void * handy_sort_task_run       ( void * arg )
+{
+    struct __handy_sort_task * task = arg;
+
+    if( task->_second == NULL )
+        task->_first = handy_sort_chain( task->_first, task->_compare, task->_ctx );
+    else
+        task->_first = handy_sort_merge( task->_first, task->_second, task->_compare, task->_ctx );
+
+    return NULL;
+}
+// run every task, the first one on the calling thread
+static void handy_sort_task_all         ( struct __handy_sort_task * tasks, int count )
+{
+    pthread_t threads[ HANDY_SORT_MAX_THREADS ];
+    bool      started[ HANDY_SORT_MAX_THREADS ];
+
+    for( int i = 1; i < count; i++ )
+        started[i] = pthread_create( &threads[i], NULL, handy_sort_task_run, &tasks[i] ) == 0;
+
+    handy_sort_task_run( &tasks[0] );
+
+    for( int i = 1; i < count; i++ )
+    {
+        // a thread that could not be started runs here instead
+        if( started[i] )
+            pthread_join( threads[i], NULL );
+        else
+            handy_sort_task_run( &tasks[i] );
     }
-    return false;
 }
-bool  handy_list_rem_at         ( handy_list self, int at )
+bool   handy_list_sort_parallel ( handy_list self, int (*compare)( void * a, void * b, void * ctx ), void * ctx, int threads )
 {
-    _handy_list_obj iter;
+    if( self->_ops != &handy_node_list_ops )
+        return false;
+
+    if( threads > HANDY_SORT_MAX_THREADS )
+        threads = HANDY_SORT_MAX_THREADS;
+    if( threads > self->_size / ( HANDY_LIST_SORT_PARALLEL_MIN / 2 ) )
+        threads = self->_size / ( HANDY_LIST_SORT_PARALLEL_MIN / 2 );
+
+    if( self->_size < HANDY_LIST_SORT_PARALLEL_MIN || threads < 2 )
+        return handy_list_sort( self, compare, ctx );
+
+    _handy_list_obj          pieces[ HANDY_SORT_MAX_THREADS ];
+    struct __handy_sort_task tasks[ HANDY_SORT_MAX_THREADS ];
+    _handy_list_obj          iter;
+
+    handy_list_normalize( self );
+
     iter = self->_first;
+    self->_last->_next = NULL;
 
-    if( at == 0 )
-        return (self->rem_front(self) );
-    else if( at == self->_size - 1 )
-        return (self->rem_back(self) );
-    else if( at > 0 || at < self->_size - 1 )
+    for( int i = 0; i < threads; i++ )
     {
-        for( int i = 0; i < self->_size; i++ )
-        {
-            if( i == at )
-            {
-
-                iter->_prev->_next = iter->_next;
-                iter->_next->_prev = iter->_prev;
-                self->_size--;
+        int length = self->_size / threads + ( i < self->_size % threads );
 
-                iter = ( free(iter), NULL );
-                return true;
-            }
+        pieces[i] = iter;
+        for( int k = 1; k < length; k++ )
             iter = iter->_next;
-        }
+
+        _handy_list_obj next = iter->_next;
+        iter->_next = NULL;
+        iter = next;
     }
 
-    return false;
+    for( int i = 0; i < threads; i++ )
+        tasks[i] = (struct __handy_sort_task){ pieces[i], NULL, compare, ctx };
+    handy_sort_task_all( tasks, threads );
+
+    for( int i = 0; i < threads; i++ )
+        pieces[i] = tasks[i]._first;
+
+    // each round halves the pieces; earlier pieces stay on the left
+    for( int count = threads; count > 1; count = ( count + 1 ) / 2 )
+    {
+        int pairs = count / 2;
+
+        for( int i = 0; i < pairs; i++ )
+            tasks[i] = (struct __handy_sort_task){ pieces[ 2 * i ], pieces[ 2 * i + 1 ], compare, ctx };
+        handy_sort_task_all( tasks, pairs );
+
+        for( int i = 0; i < pairs; i++ )
+            pieces[i] = tasks[i]._first;
+        if( count % 2 != 0 )
+            pieces[ pairs ] = pieces[ count - 1 ];
+    }
+
+    handy_sort_relink( self, pieces[0] );
+    return true;
 }
-void handy_list_reverse         ( handy_list self )
+
+// instrumentation readout; the counting itself is the HANDY_STAT macro
+
+#ifdef HANDY_LIST_STATS
+struct handy_list_stats handy_list_global_stats;
+#endif
+
+static const char * handy_list_stat_names[ HANDY_OP_COUNT ] =
 {
-    // The front point the end, and _next and _prev of every node
-    // reversed.
+    "contain", "add_front", "add_back", "add_at", "get_front", "get_back", "get_at",
+    "rem_front", "rem_back", "rem_at", "reverse", "free",
+};
 
-    _handy_list_obj hold_first = self->_first;
-    _handy_list_obj hold_last = self->_last;
+bool   handy_list_stats         ( handy_list self, struct handy_list_stats * out )
+{
+    memset( out, 0, sizeof( *out ) );
 
-    void * temp_data;
+#ifdef HANDY_LIST_STATS
+    struct handy_list_stats * from = self != NULL ? &self->_stats : &handy_list_global_stats;
 
-    // exchange front and back till we reach middle
-    for( int i = 0 ; i < (self->_size / 2); i++ )
-    {
-        temp_data = hold_first->_data;
-        hold_first->_data = hold_last->_data;
-        hold_last->_data = temp_data;
+    for( int i = 0; i < HANDY_OP_COUNT; i++ )
+        out->ops[i] = __atomic_load_n( &from->ops[i], __ATOMIC_RELAXED );
 
-        hold_first = hold_first->_next;
-        hold_last = hold_last->_prev;
-    }
+    out->hops      = __atomic_load_n( &from->hops, __ATOMIC_RELAXED );
+    out->allocs    = __atomic_load_n( &from->allocs, __ATOMIC_RELAXED );
+    out->frees     = __atomic_load_n( &from->frees, __ATOMIC_RELAXED );
+    out->peak_size = __atomic_load_n( &from->peak_size, __ATOMIC_RELAXED );
+    return true;
+#else
+    (void) self;
+    return false;
+#endif
 }
-void   handy_list_free          ( handy_list self )
+void   handy_list_stats_print   ( FILE * out, const char * label, const struct handy_list_stats * stats )
 {
-    // free every item in list and then remove them from the list
-    while( self->_first != self->_last )
-    {
-        self->_first = self->_first->_next;
+    fprintf( out, "%s:", label );
 
-        self->_first->_prev = (free( self->_first->_prev ), NULL);
-    }
-    self->_first = (free( self->_first ), NULL);
-    self->_size = 0;
+    for( int i = 0; i < HANDY_OP_COUNT; i++ )
+        fprintf( out, " %s=%lu", handy_list_stat_names[i], stats->ops[i] );
+
+    fprintf( out, " hops=%lu allocs=%lu frees=%lu peak_size=%ld\n",
+             stats->hops, stats->allocs, stats->frees, stats->peak_size );
 }
-int    handy_list_length        ( handy_list self )
+static void handy_list_stats_exit       ()
 {
-    return self->_size;
+    struct handy_list_stats stats;
+
+    if( handy_list_stats( NULL, &stats ) )
+        handy_list_stats_print( stderr, "handy_list", &stats );
+}
+void   handy_list_stats_dump_at_exit ()
+{
+    static bool registered = false;
+
+    if( !registered )
+        registered = atexit( handy_list_stats_exit ) == 0;
 }
@@ -24,10 +24,90 @@ struct __handy_list_obj
     _handy_list_obj _prev;
 };
 
+// node of a list created with HANDY_LIST_INDEXED: a plain node that is also
+// a treap node counting its subtree, so positions resolve in O(log n)
+typedef struct __handy_list_inode * _handy_list_inode;
+
+struct __handy_list_inode
+{
+    struct __handy_list_obj _obj;
+
+    _handy_list_inode _left;
+    _handy_list_inode _right;
+    _handy_list_inode _parent;
+
+    int      _count;
+    unsigned _prio;
+};
+
 #endif // HANDY_LIST_OBJ_H
 
+// creation flags for handy_create_list_with()
+#define HANDY_LIST_INDEXED  0x1     // O(log n) get_at, add_at and rem_at
+#define HANDY_LIST_HASHED   0x2     // O(1) expected contain
+
+// Instrumentation. Built with HANDY_LIST_STATS defined ( in every translation
+// unit, it changes the list header ), every list counts the operations made
+// through the handy_list_* calls, the nodes walked to find a position or an
+// item, its node allocations and frees and its largest size. The same counts
+// are summed over all lists. Without the flag the counting compiles away.
+enum handy_list_stat_op
+{
+    HANDY_OP_CONTAIN, HANDY_OP_ADD_FRONT, HANDY_OP_ADD_BACK, HANDY_OP_ADD_AT,
+    HANDY_OP_GET_FRONT, HANDY_OP_GET_BACK, HANDY_OP_GET_AT,
+    HANDY_OP_REM_FRONT, HANDY_OP_REM_BACK, HANDY_OP_REM_AT,
+    HANDY_OP_REVERSE, HANDY_OP_FREE,
+
+    HANDY_OP_COUNT
+};
+
+struct handy_list_stats
+{
+    unsigned long ops[ HANDY_OP_COUNT ];
+    unsigned long hops;             // nodes ( chunks ) stepped over
+    unsigned long allocs;
+    unsigned long frees;
+    long          peak_size;
+};
+
+#ifdef HANDY_LIST_STATS
+extern struct handy_list_stats handy_list_global_stats;
+
+// relaxed atomics: shared lists are counted from several threads
+#define HANDY_STAT( list, field, n )                                                \
+    ( __atomic_fetch_add( &(list)->_stats.field, (n), __ATOMIC_RELAXED ),           \
+      __atomic_fetch_add( &handy_list_global_stats.field, (n), __ATOMIC_RELAXED ) )
+#define HANDY_STAT_PEAK( list )     handy_list_stat_peak( list )
+#else
+#define HANDY_STAT( list, field, n )    ( (void) 0 )
+#define HANDY_STAT_PEAK( list )         ( (void) 0 )
+#endif
+
+// operations of one list implementation, shared by all of its lists
+struct _handy_list_ops
+{
+    int  (*contain)         ( handy_list self, void * item );
+    bool (*add_front)       ( handy_list self, void * item );
+    bool (*add_back)        ( handy_list self, void * item );
+    bool (*add_at)          ( handy_list self, void * item, int at );
+    bool (*empty)           ( handy_list self );
+
+    void * (*get_front)     ( handy_list self );
+    void * (*get_back)      ( handy_list self );
+    void * (*get_at)        ( handy_list self, int at );
+    bool   (*rem_front)     ( handy_list self );
+    bool   (*rem_back)      ( handy_list self );
+    void   (*reverse)       ( handy_list self );
+    bool   (*rem_at)        ( handy_list self, int at );
+    void   (*free)          ( handy_list self );
+    int    (*length)        ( handy_list self );
+};
+
+// Code still calling list->op( list, ... ) can define HANDY_LIST_LEGACY_VTABLE
+// ( in every translation unit ) to get the per-list pointer copies back.
 struct _handy_list_struct
 {
+#ifdef HANDY_LIST_LEGACY_VTABLE
     int  (*contain)         ( handy_list self, void * item );
     bool (*add_front)       ( handy_list self, void * item );
     bool (*add_back)        ( handy_list self, void * item );
@@ -43,13 +123,275 @@ struct _handy_list_struct
     bool   (*rem_at)        ( handy_list self, int at );
     void   (*free)          ( handy_list self );
     int    (*length)        ( handy_list self );
+#endif
+
+    const struct _handy_list_ops * _ops;
 
     _handy_list_obj _first;
     _handy_list_obj _last;
 
     int _size;
+    bool _reversed;                 // read from _last towards _first
+
+    unsigned          _flags;
+    _handy_list_inode _root;
+    struct __handy_list_hash * _hash;
+    struct __handy_pool * _pool;    // pool the nodes came from
+
+#ifdef HANDY_LIST_STATS
+    struct handy_list_stats _stats;
+#endif
 };
 
+#ifdef HANDY_LIST_STATS
+static inline void handy_list_stat_max  ( long * peak, long size )
+{
+    long seen = __atomic_load_n( peak, __ATOMIC_RELAXED );
+
+    while( size > seen &&
+           !__atomic_compare_exchange_n( peak, &seen, size, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+        ;
+}
+static inline void handy_list_stat_peak ( handy_list self )
+{
+    // a shared list publishes its size atomically
+    long size = __atomic_load_n( &self->_size, __ATOMIC_RELAXED );
+
+    handy_list_stat_max( &self->_stats.peak_size, size );
+    handy_list_stat_max( &handy_list_global_stats.peak_size, size );
+}
+#endif
+
+// counts of one list, or with NULL of all lists; false, and zeros, when
+// built without HANDY_LIST_STATS
+extern bool handy_list_stats( handy_list self, struct handy_list_stats * out );
+// write counts as one line of name=value pairs headed by label
+extern void handy_list_stats_print( FILE * out, const char * label, const struct handy_list_stats * stats );
+// print the counts of all lists to stderr when the program exits
+extern void handy_list_stats_dump_at_exit();
+
 extern handy_list handy_create_list();
+extern handy_list handy_create_list_with( unsigned flags );
+
+// for list implementations: reset a header and point it at its ops table
+extern void handy_list_init_header( handy_list self, const struct _handy_list_ops * ops );
+
+extern const struct _handy_list_ops handy_node_list_ops;
+
+// Calls go through the shared table; length and empty, and the ends of a
+// node list, are plain loads the compiler can inline. The size is read
+// atomically, as a shared list changes it under its readers.
+
+static inline int    handy_list_length    ( handy_list self )
+{
+    return __atomic_load_n( &self->_size, __ATOMIC_ACQUIRE );
+}
+static inline bool   handy_list_empty     ( handy_list self )
+{
+    return __atomic_load_n( &self->_size, __ATOMIC_ACQUIRE ) == 0;
+}
+static inline void * handy_list_get_front ( handy_list self )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_GET_FRONT ], 1 );
+    if( self->_ops == &handy_node_list_ops )
+    {
+        _handy_list_obj end = self->_reversed ? self->_last : self->_first;
+        return end != NULL ? end->_data : NULL;
+    }
+    return self->_ops->get_front( self );
+}
+static inline void * handy_list_get_back  ( handy_list self )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_GET_BACK ], 1 );
+    if( self->_ops == &handy_node_list_ops )
+    {
+        _handy_list_obj end = self->_reversed ? self->_first : self->_last;
+        return end != NULL ? end->_data : NULL;
+    }
+    return self->_ops->get_back( self );
+}
+static inline int    handy_list_contain   ( handy_list self, void * item )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_CONTAIN ], 1 );
+    return self->_ops->contain( self, item );
+}
+static inline bool   handy_list_add_front ( handy_list self, void * item )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_ADD_FRONT ], 1 );
+    bool done = self->_ops->add_front( self, item );
+    HANDY_STAT_PEAK( self );
+    return done;
+}
+static inline bool   handy_list_add_back  ( handy_list self, void * item )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_ADD_BACK ], 1 );
+    bool done = self->_ops->add_back( self, item );
+    HANDY_STAT_PEAK( self );
+    return done;
+}
+static inline bool   handy_list_add_at    ( handy_list self, void * item, int at )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_ADD_AT ], 1 );
+    bool done = self->_ops->add_at( self, item, at );
+    HANDY_STAT_PEAK( self );
+    return done;
+}
+static inline void * handy_list_get_at    ( handy_list self, int at )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_GET_AT ], 1 );
+    return self->_ops->get_at( self, at );
+}
+static inline bool   handy_list_rem_front ( handy_list self )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_REM_FRONT ], 1 );
+    return self->_ops->rem_front( self );
+}
+static inline bool   handy_list_rem_back  ( handy_list self )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_REM_BACK ], 1 );
+    return self->_ops->rem_back( self );
+}
+static inline bool   handy_list_rem_at    ( handy_list self, int at )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_REM_AT ], 1 );
+    return self->_ops->rem_at( self, at );
+}
+// O(1) on a node list: it only flips the reading direction
+static inline void   handy_list_reverse   ( handy_list self )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_REVERSE ], 1 );
+    self->_ops->reverse( self );
+}
+static inline void   handy_list_free      ( handy_list self )
+{
+    HANDY_STAT( self, ops[ HANDY_OP_FREE ], 1 );
+    self->_ops->free( self );
+}
+
+// relink a reversed node list so that its nodes run front to back again;
+// O(n), and nothing changes for any reader
+extern void   handy_list_normalize( handy_list self );
+
+// bytes held by the side indexes requested at creation
+extern size_t handy_list_index_bytes( handy_list self );
+// bring lazily kept index state up to date: after a change in the middle
+// of a hashed list without HANDY_LIST_INDEXED, contain walks up to n / 2
+// nodes per match until this renumbers it in O(n)
+extern void   handy_list_index_refresh( handy_list self );
+
+// Bulk moves between node lists. splice inserts all of other before
+// position at and concat appends it; both leave other empty. split_at moves
+// positions at .. end into a new list. Nodes are relinked, not copied, so
+// these are O(1) for plain lists and O(log n) with HANDY_LIST_INDEXED;
+// a hashed list also re-indexes the moved items; a list indexed unlike
+// self is copied across in O(n). add_back_n takes its nodes a whole slab
+// at a time. All of them work on node lists only and fail ( false, NULL )
+// on any other kind, leaving it untouched.
+extern bool       handy_list_splice     ( handy_list self, int at, handy_list other );
+extern bool       handy_list_concat     ( handy_list self, handy_list other );
+extern handy_list handy_list_split_at   ( handy_list self, int at );
+extern bool       handy_list_add_back_n ( handy_list self, void ** items, int count );
+
+// Stable merge sort of a node list: nodes are relinked, nothing is copied
+// or allocated, and any side index is brought along. compare returns less
+// than, equal to or greater than zero, like strcmp. sort_parallel spreads
+// lists of HANDY_LIST_SORT_PARALLEL_MIN items or more over up to threads
+// threads, so compare must then be safe to call from several at once.
+// Both return false for lists that are not node lists.
+#define HANDY_LIST_SORT_PARALLEL_MIN 65536
+
+extern bool handy_list_sort          ( handy_list self, int (*compare)( void * a, void * b, void * ctx ), void * ctx );
+extern bool handy_list_sort_parallel ( handy_list self, int (*compare)( void * a, void * b, void * ctx ), void * ctx, int threads );
+
+// Cursor over the nodes of a list from handy_create_list(_with): each step
+// is one hop. Erasing moves the cursor to the next element and inserting
+// places the item before it, so neither invalidates the cursor.
+typedef struct _handy_list_cursor
+{
+    handy_list      _list;
+    _handy_list_obj _node;          // NULL once walked off either end
+    int             _index;
+} handy_list_cursor;
+
+extern void   handy_list_cursor_begin  ( handy_list self, handy_list_cursor * cursor );
+extern void   handy_list_cursor_end    ( handy_list self, handy_list_cursor * cursor );
+extern bool   handy_list_cursor_valid  ( handy_list_cursor * cursor );
+extern void * handy_list_cursor_get    ( handy_list_cursor * cursor );
+extern bool   handy_list_cursor_next   ( handy_list_cursor * cursor );
+extern bool   handy_list_cursor_prev   ( handy_list_cursor * cursor );
+extern bool   handy_list_cursor_insert_before ( handy_list_cursor * cursor, void * item );
+extern bool   handy_list_cursor_erase  ( handy_list_cursor * cursor );
+
+// visit every item front to back; visit returns false to stop early
+extern void   handy_list_for_each      ( handy_list self, bool (*visit)( void * item, void * ctx ), void * ctx );
+// drop every item pred accepts in one pass; returns how many went
+extern int    handy_list_remove_if     ( handy_list self, bool (*pred)( void * item, void * ctx ), void * ctx );
+
+// same interface over cache-line-sized chunks of pointers ( handy_chunk_list.c )
+extern handy_list handy_create_chunk_list();
+
+// same interface over one growable ring buffer of pointers
+// ( handy_deque_list.c ): O(1) at both ends and get_at, no per-item allocation
+extern handy_list handy_create_deque_list();
+
+// list holding up to HANDY_SMALL_ITEMS items inside its own allocation
+// ( handy_small_list.c ); one more turns it into a node list created with
+// flags, for good
+#define HANDY_SMALL_ITEMS   8
+
+extern handy_list handy_create_small_list( unsigned flags );
+
+// list whose nodes live in the file at path, mapped into memory and paged
+// by the kernel ( handy_mapped_list.c ); an existing file is reopened with
+// its items. Items are kept as 64-bit words. Changes reach the file as the
+// kernel writes pages back; handy_list_checkpoint forces them out and
+// returns once they are on disk. A file whose header does not add up is
+// refused. Freeing the list closes the file, keeping the items in it, and
+// leaves an empty list in memory that can be used, or freed, like any other.
+extern handy_list handy_create_mapped_list( const char * path );
+extern bool       handy_list_checkpoint( handy_list self );
+
+// node list safe to share between threads ( handy_shared_list.c ): reads
+// run side by side, and a writer at one end runs side by side with the
+// writers and readers of the other
+extern handy_list handy_create_shared_list( unsigned flags );
+
+// Binary dump of a list's items ( handy_list_file.c ). Without a codec the
+// item pointers themselves are stored, which suits scalar payloads cast to
+// void *. With one, each item is written as a record of size() bytes by
+// write(). handy_list_open maps a saved file as a read-only list: scalar
+// items come back as they went in, record items as pointers to their bytes
+// inside the mapping, 8-byte aligned and valid until the list is freed; a
+// record whose stored extent does not lie inside the file reads as NULL.
+// save syncs the file to disk before renaming it into place. Files are in
+// host byte order; another kind of host refuses them.
+struct handy_list_codec
+{
+    size_t (*size)  ( void * item, void * ctx );
+    void   (*write) ( void * item, void * out, void * ctx );
+    void *  ctx;
+};
+
+extern bool       handy_list_save( handy_list self, const char * path, const struct handy_list_codec * codec );
+extern handy_list handy_list_open( const char * path );
+
+// Nodes of every list built on a thread come from that thread's slab pool.
+// mallocs_avoided is node_allocs minus the slab mallocs that fed them.
+struct handy_list_pool_stats
+{
+    unsigned long node_allocs;
+    unsigned long node_frees;
+    unsigned long slab_mallocs;
+    unsigned long mallocs_avoided;
+    long          live_nodes;
+};
+
+extern void handy_list_pool_stats( struct handy_list_pool_stats * out );
+
+// Release this thread's slabs; refused (false) while any node made on this
+// thread is in use, wherever it lives. Nodes freed on another thread go back
+// to the pool that made them, and a thread's pool is released when the
+// thread exits and its last node has come back.
+extern bool handy_list_pool_trim();
 
 #endif //HANDY_LIST_H
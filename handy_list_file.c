@@ -0,0 +1,391 @@
+// binary dump of a list and a read-only list view over the mapped file
+//
+// Layout, in host byte order:
+//
+//     header      magic, byte order mark, kind, item count
+//     scalar:     one 64-bit word per item, the item pointer itself
+//     records:    count + 1 64-bit file offsets, then the records, each
+//                 starting on an 8-byte boundary; record i runs up to
+//                 offset i + 1
+//
+// Opening maps the file and reads items straight out of the mapping: a
+// scalar item is its word, a record item is a pointer to its bytes. No
+// item is decoded or allocated, so opening costs the same at any size.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "handy_list.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HANDY_FILE_MAGIC    "HANDYLS1"
+#define HANDY_FILE_BOM      0x01020304u
+#define HANDY_FILE_ALIGN    8
+
+enum { HANDY_FILE_SCALAR, HANDY_FILE_RECORDS };
+
+struct __handy_file_header
+{
+    char     _magic[8];
+    uint32_t _bom;                  // reads differently on a foreign host
+    uint32_t _kind;
+    uint64_t _count;
+};
+
+typedef struct _handy_view_list_struct * handy_view_list;
+
+struct _handy_view_list_struct
+{
+    struct _handy_list_struct _base;
+
+    void *           _map;
+    size_t           _map_bytes;
+    const uint64_t * _words;        // scalar items, or record offsets
+    uint64_t         _records_from; // end of the offset table
+    bool             _records;
+};
+
+int    handy_view_list_contain      ( handy_list self, void * item );
+bool   handy_view_list_add_front    ( handy_list self, void * item );
+bool   handy_view_list_add_back     ( handy_list self, void * item );
+bool   handy_view_list_add_at       ( handy_list self, void * item, int at );
+bool   handy_view_list_empty        ( handy_list self );
+
+void * handy_view_list_get_front    ( handy_list self );
+void * handy_view_list_get_back     ( handy_list self );
+void * handy_view_list_get_at       ( handy_list self, int at );
+bool   handy_view_list_rem_front    ( handy_list self );
+bool   handy_view_list_rem_back     ( handy_list self );
+bool   handy_view_list_rem_at       ( handy_list self, int at );
+void   handy_view_list_reverse      ( handy_list self );
+void   handy_view_list_free         ( handy_list self );
+int    handy_view_list_length       ( handy_list self );
+
+static const struct _handy_list_ops handy_view_list_ops =
+{
+    .contain       = handy_view_list_contain,
+    .add_front     = handy_view_list_add_front,
+    .add_back      = handy_view_list_add_back,
+    .add_at        = handy_view_list_add_at,
+    .empty         = handy_view_list_empty,
+    .get_front     = handy_view_list_get_front,
+    .get_back      = handy_view_list_get_back,
+    .get_at        = handy_view_list_get_at,
+    .rem_front     = handy_view_list_rem_front,
+    .rem_back      = handy_view_list_rem_back,
+    .reverse       = handy_view_list_reverse,
+    .rem_at        = handy_view_list_rem_at,
+    .free          = handy_view_list_free,
+    .length        = handy_view_list_length,
+};
+
+// saving
+
+struct __handy_file_writer
+{
+    FILE *                          _out;
+    const struct handy_list_codec * _codec;
+    uint64_t *                      _offsets;   // records: where each one goes
+    char *                          _buffer;
+    size_t                          _buffer_bytes;
+    int                             _index;
+    bool                            _failed;
+};
+
+static bool handy_file_put_word         ( void * item, void * ctx )
+{
+    struct __handy_file_writer * writer = ctx;
+    uint64_t                     word = (uint64_t)(uintptr_t) item;
+
+    if( fwrite( &word, sizeof( word ), 1, writer->_out ) != 1 )
+        writer->_failed = true;
+    return !writer->_failed;
+}
+static bool handy_file_measure          ( void * item, void * ctx )
+{
+    struct __handy_file_writer * writer = ctx;
+    size_t                       bytes = writer->_codec->size( item, writer->_codec->ctx );
+
+    bytes = ( bytes + HANDY_FILE_ALIGN - 1 ) & ~(size_t)( HANDY_FILE_ALIGN - 1 );
+    writer->_offsets[ writer->_index + 1 ] = writer->_offsets[ writer->_index ] + bytes;
+    writer->_index++;
+    return true;
+}
+static bool handy_file_put_record       ( void * item, void * ctx )
+{
+    struct __handy_file_writer * writer = ctx;
+    size_t bytes = writer->_offsets[ writer->_index + 1 ] - writer->_offsets[ writer->_index ];
+
+    if( bytes > writer->_buffer_bytes )
+    {
+        char * grown = realloc( writer->_buffer, bytes );
+        if( grown == NULL )
+            return !( writer->_failed = true );
+
+        writer->_buffer = grown;
+        writer->_buffer_bytes = bytes;
+    }
+
+    // padding is zeroed so equal lists give equal files
+    memset( writer->_buffer, 0, bytes );
+    writer->_codec->write( item, writer->_buffer, writer->_codec->ctx );
+
+    if( fwrite( writer->_buffer, 1, bytes, writer->_out ) != bytes )
+        writer->_failed = true;
+
+    writer->_index++;
+    return !writer->_failed;
+}
+// every item front to back, through for_each where the list has one
+static void handy_file_each             ( handy_list self, bool (*visit)( void * item, void * ctx ), void * ctx )
+{
+    if( self->_ops == &handy_node_list_ops )
+    {
+        handy_list_for_each( self, visit, ctx );
+        return;
+    }
+    for( int i = 0; i < handy_list_length( self ); i++ )
+    {
+        if( !visit( handy_list_get_at( self, i ), ctx ) )
+            return;
+    }
+}
+bool   handy_list_save          ( handy_list self, const char * path, const struct handy_list_codec * codec )
+{
+    struct __handy_file_writer writer = { ._codec = codec };
+    struct __handy_file_header header = { ._bom = HANDY_FILE_BOM };
+    int                        count = handy_list_length( self );
+
+    memcpy( header._magic, HANDY_FILE_MAGIC, sizeof( header._magic ) );
+    header._kind = codec != NULL ? HANDY_FILE_RECORDS : HANDY_FILE_SCALAR;
+    header._count = count;
+
+    if( codec != NULL )
+    {
+        // first pass lays the records out, so the offset table goes first
+        writer._offsets = malloc( ( count + 1 ) * sizeof( uint64_t ) );
+        if( writer._offsets == NULL )
+            return false;
+
+        writer._offsets[0] = sizeof( header ) + ( count + 1 ) * sizeof( uint64_t );
+        handy_file_each( self, handy_file_measure, &writer );
+        writer._index = 0;
+    }
+
+    // written beside the target and renamed over it, so a reader never
+    // maps a half written file
+    size_t length = strlen( path );
+    char * temp_path = malloc( length + 5 );
+
+    if( temp_path == NULL )
+    {
+        free( writer._offsets );
+        return false;
+    }
+    memcpy( temp_path, path, length );
+    memcpy( temp_path + length, ".tmp", 5 );
+
+    writer._out = fopen( temp_path, "wb" );
+    if( writer._out == NULL )
+    {
+        msg_e( "handy_list_save", "cannot create the list file" );
+        free( temp_path );
+        free( writer._offsets );
+        return false;
+    }
+
+    writer._failed = fwrite( &header, sizeof( header ), 1, writer._out ) != 1;
+
+    if( !writer._failed && codec == NULL )
+        handy_file_each( self, handy_file_put_word, &writer );
+    else if( !writer._failed )
+    {
+        writer._failed = fwrite( writer._offsets, sizeof( uint64_t ), count + 1, writer._out ) != (size_t)( count + 1 );
+        if( !writer._failed )
+            handy_file_each( self, handy_file_put_record, &writer );
+    }
+
+    // on disk before the rename, or a crash could leave the new name on a
+    // file whose data never made it
+    if( !writer._failed && ( fflush( writer._out ) != 0 || fsync( fileno( writer._out ) ) != 0 ) )
+        writer._failed = true;
+
+    if( fclose( writer._out ) != 0 )
+        writer._failed = true;
+
+    if( writer._failed || rename( temp_path, path ) != 0 )
+    {
+        msg_e( "handy_list_save", "cannot write the list file" );
+        remove( temp_path );
+        writer._failed = true;
+    }
+
+    free( writer._buffer );
+    free( writer._offsets );
+    free( temp_path );
+    return !writer._failed;
+}
+
+// opening
+
+handy_list handy_list_open      ( const char * path )
+{
+    int fd = open( path, O_RDONLY );
+    if( fd < 0 )
+        return NULL;
+
+    struct stat info;
+    if( fstat( fd, &info ) != 0 || (size_t) info.st_size < sizeof( struct __handy_file_header ) )
+    {
+        close( fd );
+        msg_e( "handy_list_open", "not a list file" );
+        return NULL;
+    }
+
+    size_t bytes = info.st_size;
+    void * map = mmap( NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    close( fd );
+    if( map == MAP_FAILED )
+        return NULL;
+
+    const struct __handy_file_header * header = map;
+    bool                                records = header->_kind == HANDY_FILE_RECORDS;
+    uint64_t                            words = header->_count + ( records ? 1 : 0 );
+
+    // the word table must fit; records are range checked as they are read,
+    // so a bad offset costs its own item, not the open
+    if( memcmp( header->_magic, HANDY_FILE_MAGIC, sizeof( header->_magic ) ) != 0 ||
+        header->_bom != HANDY_FILE_BOM || header->_kind > HANDY_FILE_RECORDS ||
+        header->_count > INT32_MAX || words > ( bytes - sizeof( *header ) ) / sizeof( uint64_t ) )
+    {
+        munmap( map, bytes );
+        msg_e( "handy_list_open", "not a list file, or written on another kind of host" );
+        return NULL;
+    }
+
+    handy_view_list temp_list = malloc( sizeof(*temp_list) );
+    if( temp_list == NULL )
+    {
+        munmap( map, bytes );
+        return NULL;
+    }
+
+    handy_list_init_header( &temp_list->_base, &handy_view_list_ops );
+    temp_list->_base._size = (int) header->_count;
+
+    temp_list->_map = map;
+    temp_list->_map_bytes = bytes;
+    temp_list->_words = (const uint64_t *)( header + 1 );
+    temp_list->_records_from = sizeof( *header ) + words * sizeof( uint64_t );
+    temp_list->_records = records;
+
+    return &temp_list->_base;
+}
+
+// the view: positions map straight onto the word table, and reverse only
+// flips the reading direction
+
+static void * handy_view_item           ( handy_view_list self, int at )
+{
+    if( self->_base._reversed )
+        at = self->_base._size - 1 - at;
+
+    if( !self->_records )
+        return (void *)(uintptr_t) self->_words[ at ];
+
+    // the whole record, up to the next offset, must lie past the table and
+    // inside the mapping
+    uint64_t offset = self->_words[ at ];
+    uint64_t end    = self->_words[ at + 1 ];
+
+    if( offset < self->_records_from || offset % HANDY_FILE_ALIGN != 0 ||
+        end < offset || end > self->_map_bytes )
+        return NULL;
+
+    return (char *) self->_map + offset;
+}
+
+int    handy_view_list_contain      ( handy_list self, void * item )
+{
+    for( int i = 0; i < self->_size; i++ )
+    {
+        if( handy_view_item( (handy_view_list) self, i ) == item )
+            return i;
+    }
+    return -1;
+}
+bool   handy_view_list_add_front    ( handy_list self, void * item )
+{
+    (void) self, (void) item;
+    return false;
+}
+bool   handy_view_list_add_back     ( handy_list self, void * item )
+{
+    (void) self, (void) item;
+    return false;
+}
+bool   handy_view_list_add_at       ( handy_list self, void * item, int at )
+{
+    (void) self, (void) item, (void) at;
+    return false;
+}
+bool   handy_view_list_empty        ( handy_list self )
+{
+    return self->_size == 0 ? true : false;
+}
+void * handy_view_list_get_front    ( handy_list self )
+{
+    return self->_size > 0 ? handy_view_item( (handy_view_list) self, 0 ) : NULL;
+}
+void * handy_view_list_get_back     ( handy_list self )
+{
+    return self->_size > 0 ? handy_view_item( (handy_view_list) self, self->_size - 1 ) : NULL;
+}
+void * handy_view_list_get_at       ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return NULL;
+
+    return handy_view_item( (handy_view_list) self, at );
+}
+bool   handy_view_list_rem_front    ( handy_list self )
+{
+    (void) self;
+    return false;
+}
+bool   handy_view_list_rem_back     ( handy_list self )
+{
+    (void) self;
+    return false;
+}
+bool   handy_view_list_rem_at       ( handy_list self, int at )
+{
+    (void) self, (void) at;
+    return false;
+}
+void   handy_view_list_reverse      ( handy_list self )
+{
+    self->_reversed = !self->_reversed;
+}
+void   handy_view_list_free         ( handy_list self )
+{
+    handy_view_list list = (handy_view_list) self;
+
+    if( list->_map != NULL )
+        munmap( list->_map, list->_map_bytes );
+
+    list->_map = NULL;
+    list->_map_bytes = 0;
+    list->_words = NULL;
+    self->_size = 0;
+}
+int    handy_view_list_length       ( handy_list self )
+{
+    return self->_size;
+}
@@ -0,0 +1,450 @@
+// file-backed implementation of the handy_list interface
+//
+// Nodes live in a file mapped shared into memory and link to each other
+// by slot number, not by address, so the file can be mapped anywhere and
+// grown by remapping. The kernel pages nodes in and out as they are
+// touched; a list far larger than memory only keeps its working set
+// resident. Layout, in host byte order:
+//
+//     header      magic, byte order mark, list state
+//     slots       one node per slot: item word, next and prev slot numbers
+//
+// Slot 0 stands for "no node". Removed nodes go on a free chain and are
+// reused before the file grows. Items are stored as 64-bit words, so a
+// list that is to outlive the process must hold scalar payloads cast to
+// void *, as with handy_list_save.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "handy_list.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HANDY_MAPPED_MAGIC  "HANDYMP1"
+#define HANDY_MAPPED_BOM    0x01020304u
+#define HANDY_MAPPED_SLOTS  1024    // slots of a new file
+
+struct __handy_mapped_header
+{
+    char     _magic[8];
+    uint32_t _bom;
+    uint32_t _reversed;
+    uint64_t _slots;                // slots the file has room for
+    uint64_t _used;                 // slots ever handed out, from 1
+    uint64_t _size;
+    uint64_t _first;
+    uint64_t _last;
+    uint64_t _free;                 // chain of removed slots, through _next
+};
+
+struct __handy_mapped_node
+{
+    uint64_t _data;
+    uint64_t _next;
+    uint64_t _prev;
+};
+
+typedef struct _handy_mapped_list_struct * handy_mapped_list;
+
+struct _handy_mapped_list_struct
+{
+    struct _handy_list_struct _base;
+
+    int                            _fd;
+    size_t                         _map_bytes;
+    struct __handy_mapped_header * _header;     // start of the mapping
+    struct __handy_mapped_node *   _nodes;      // slot 0 included
+};
+
+int    handy_mapped_list_contain    ( handy_list self, void * item );
+bool   handy_mapped_list_add_front  ( handy_list self, void * item );
+bool   handy_mapped_list_add_back   ( handy_list self, void * item );
+bool   handy_mapped_list_add_at     ( handy_list self, void * item, int at );
+bool   handy_mapped_list_empty      ( handy_list self );
+
+void * handy_mapped_list_get_front  ( handy_list self );
+void * handy_mapped_list_get_back   ( handy_list self );
+void * handy_mapped_list_get_at     ( handy_list self, int at );
+bool   handy_mapped_list_rem_front  ( handy_list self );
+bool   handy_mapped_list_rem_back   ( handy_list self );
+bool   handy_mapped_list_rem_at     ( handy_list self, int at );
+void   handy_mapped_list_reverse    ( handy_list self );
+void   handy_mapped_list_free       ( handy_list self );
+int    handy_mapped_list_length     ( handy_list self );
+
+static const struct _handy_list_ops handy_mapped_list_ops =
+{
+    .contain       = handy_mapped_list_contain,
+    .add_front     = handy_mapped_list_add_front,
+    .add_back      = handy_mapped_list_add_back,
+    .add_at        = handy_mapped_list_add_at,
+    .empty         = handy_mapped_list_empty,
+    .get_front     = handy_mapped_list_get_front,
+    .get_back      = handy_mapped_list_get_back,
+    .get_at        = handy_mapped_list_get_at,
+    .rem_front     = handy_mapped_list_rem_front,
+    .rem_back      = handy_mapped_list_rem_back,
+    .reverse       = handy_mapped_list_reverse,
+    .rem_at        = handy_mapped_list_rem_at,
+    .free          = handy_mapped_list_free,
+    .length        = handy_mapped_list_length,
+};
+
+static size_t handy_mapped_bytes        ( uint64_t slots )
+{
+    return sizeof( struct __handy_mapped_header ) + slots * sizeof( struct __handy_mapped_node );
+}
+// (re)map the first bytes of the file
+static bool handy_mapped_map            ( handy_mapped_list self, size_t bytes )
+{
+    void * map = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, self->_fd, 0 );
+    if( map == MAP_FAILED )
+        return false;
+
+    if( self->_header != NULL )
+        munmap( self->_header, self->_map_bytes );
+
+    self->_header = map;
+    self->_nodes = (struct __handy_mapped_node *)( self->_header + 1 );
+    self->_map_bytes = bytes;
+    return true;
+}
+
+// a header this build can use over a file of bytes, with every slot
+// number inside the slots handed out
+static bool handy_mapped_valid          ( const struct __handy_mapped_header * header, size_t bytes )
+{
+    if( memcmp( header->_magic, HANDY_MAPPED_MAGIC, sizeof( header->_magic ) ) != 0 ||
+        header->_bom != HANDY_MAPPED_BOM )
+        return false;
+
+    if( header->_slots > ( bytes - sizeof( *header ) ) / sizeof( struct __handy_mapped_node ) ||
+        header->_used == 0 || header->_used > header->_slots )
+        return false;
+
+    if( header->_first >= header->_used || header->_last >= header->_used ||
+        header->_free >= header->_used )
+        return false;
+
+    // an empty list has no ends, and a list cannot hold more nodes than slots
+    if( header->_size >= header->_used || header->_size > INT32_MAX ||
+        ( header->_size == 0 ) != ( header->_first == 0 ) ||
+        ( header->_first == 0 ) != ( header->_last == 0 ) )
+        return false;
+
+    return true;
+}
+
+handy_list handy_create_mapped_list ( const char * path )
+{
+    int fd = open( path, O_RDWR | O_CREAT, 0644 );
+    if( fd < 0 )
+    {
+        msg_e( "handy_create_mapped_list", "cannot open the list file" );
+        return NULL;
+    }
+
+    struct stat info;
+    if( fstat( fd, &info ) != 0 )
+    {
+        close( fd );
+        return NULL;
+    }
+
+    bool fresh = info.st_size == 0;
+
+    if( fresh && ftruncate( fd, handy_mapped_bytes( HANDY_MAPPED_SLOTS ) ) != 0 )
+    {
+        close( fd );
+        msg_e( "handy_create_mapped_list", "cannot size the list file" );
+        return NULL;
+    }
+
+    handy_mapped_list temp_list = malloc( sizeof(*temp_list) );
+    if( temp_list == NULL )
+    {
+        close( fd );
+        return NULL;
+    }
+
+    handy_list_init_header( &temp_list->_base, &handy_mapped_list_ops );
+    temp_list->_fd = fd;
+    temp_list->_header = NULL;
+
+    size_t bytes = fresh ? handy_mapped_bytes( HANDY_MAPPED_SLOTS ) : (size_t) info.st_size;
+
+    if( bytes < sizeof( struct __handy_mapped_header ) || !handy_mapped_map( temp_list, bytes ) )
+    {
+        close( fd );
+        free( temp_list );
+        msg_e( "handy_create_mapped_list", "not a list file" );
+        return NULL;
+    }
+
+    struct __handy_mapped_header * header = temp_list->_header;
+
+    if( fresh )
+    {
+        memcpy( header->_magic, HANDY_MAPPED_MAGIC, sizeof( header->_magic ) );
+        header->_bom = HANDY_MAPPED_BOM;
+        header->_slots = HANDY_MAPPED_SLOTS;
+        header->_used = 1;
+    }
+    else if( !handy_mapped_valid( header, bytes ) )
+    {
+        munmap( temp_list->_header, temp_list->_map_bytes );
+        close( fd );
+        free( temp_list );
+        msg_e( "handy_create_mapped_list", "not a list file, or written on another kind of host" );
+        return NULL;
+    }
+
+    temp_list->_base._size = (int) header->_size;
+    temp_list->_base._reversed = header->_reversed != 0;
+
+    return &temp_list->_base;
+}
+bool   handy_list_checkpoint    ( handy_list self )
+{
+    if( self->_ops != &handy_mapped_list_ops )
+        return false;
+
+    handy_mapped_list list = (handy_mapped_list) self;
+
+    return msync( list->_header, list->_map_bytes, MS_SYNC ) == 0;
+}
+
+// slots
+
+static inline struct __handy_mapped_node * handy_mapped_node ( handy_mapped_list self, uint64_t slot )
+{
+    return &self->_nodes[ slot ];
+}
+// a free slot holding item, growing the file when none is left; 0 when
+// the file cannot grow
+static uint64_t handy_mapped_alloc      ( handy_mapped_list self, void * item )
+{
+    struct __handy_mapped_header * header = self->_header;
+    uint64_t                       slot = header->_free;
+
+    if( slot != 0 )
+        header->_free = handy_mapped_node( self, slot )->_next;
+    else
+    {
+        if( header->_used == header->_slots )
+        {
+            uint64_t slots = header->_slots * 2;
+            size_t   bytes = handy_mapped_bytes( slots );
+
+            if( ftruncate( self->_fd, bytes ) != 0 || !handy_mapped_map( self, bytes ) )
+            {
+                msg_e( "handy_mapped_alloc", "cannot grow the list file" );
+                return 0;
+            }
+            header = self->_header;
+            header->_slots = slots;
+        }
+        slot = header->_used++;
+    }
+
+    HANDY_STAT( &self->_base, allocs, 1 );
+
+    handy_mapped_node( self, slot )->_data = (uint64_t)(uintptr_t) item;
+    return slot;
+}
+static void handy_mapped_release        ( handy_mapped_list self, uint64_t slot )
+{
+    HANDY_STAT( &self->_base, frees, 1 );
+
+    handy_mapped_node( self, slot )->_next = self->_header->_free;
+    self->_header->_free = slot;
+}
+// slot at physical position at, walked from the nearer end
+static uint64_t handy_mapped_slot_at    ( handy_mapped_list self, uint64_t at )
+{
+    struct __handy_mapped_header * header = self->_header;
+    uint64_t                       slot;
+
+    if( at < header->_size / 2 )
+    {
+        for( slot = header->_first; at > 0; at-- )
+        {
+            HANDY_STAT( &self->_base, hops, 1 );
+            slot = handy_mapped_node( self, slot )->_next;
+        }
+    }
+    else
+    {
+        for( slot = header->_last, at = header->_size - 1 - at; at > 0; at-- )
+        {
+            HANDY_STAT( &self->_base, hops, 1 );
+            slot = handy_mapped_node( self, slot )->_prev;
+        }
+    }
+    return slot;
+}
+// physical position of logical position at
+static inline uint64_t handy_mapped_pos ( handy_mapped_list self, int at )
+{
+    return self->_base._reversed ? (uint64_t)( self->_base._size - 1 - at ) : (uint64_t) at;
+}
+// link a new node holding item in before physical position at
+static bool handy_mapped_insert         ( handy_mapped_list self, void * item, uint64_t at )
+{
+    uint64_t slot = handy_mapped_alloc( self, item );
+    if( slot == 0 )
+        return false;
+
+    struct __handy_mapped_header * header = self->_header;
+    struct __handy_mapped_node *   node = handy_mapped_node( self, slot );
+    uint64_t                       next = at < header->_size ? handy_mapped_slot_at( self, at ) : 0;
+    uint64_t                       prev = next != 0 ? handy_mapped_node( self, next )->_prev : header->_last;
+
+    node->_next = next;
+    node->_prev = prev;
+
+    if( prev != 0 )
+        handy_mapped_node( self, prev )->_next = slot;
+    else
+        header->_first = slot;
+
+    if( next != 0 )
+        handy_mapped_node( self, next )->_prev = slot;
+    else
+        header->_last = slot;
+
+    self->_base._size = (int) ++header->_size;
+    return true;
+}
+static void handy_mapped_unlink         ( handy_mapped_list self, uint64_t slot )
+{
+    struct __handy_mapped_header * header = self->_header;
+    struct __handy_mapped_node *   node = handy_mapped_node( self, slot );
+
+    if( node->_prev != 0 )
+        handy_mapped_node( self, node->_prev )->_next = node->_next;
+    else
+        header->_first = node->_next;
+
+    if( node->_next != 0 )
+        handy_mapped_node( self, node->_next )->_prev = node->_prev;
+    else
+        header->_last = node->_prev;
+
+    handy_mapped_release( self, slot );
+    self->_base._size = (int) --header->_size;
+}
+
+int    handy_mapped_list_contain    ( handy_list self, void * item )
+{
+    handy_mapped_list list = (handy_mapped_list) self;
+    uint64_t          word = (uint64_t)(uintptr_t) item;
+    uint64_t          slot = self->_reversed ? list->_header->_last : list->_header->_first;
+
+    for( int i = 0; slot != 0; i++ )
+    {
+        struct __handy_mapped_node * node = handy_mapped_node( list, slot );
+
+        if( node->_data == word )
+            return i;
+
+        HANDY_STAT( self, hops, 1 );
+        slot = self->_reversed ? node->_prev : node->_next;
+    }
+    return -1;
+}
+bool   handy_mapped_list_add_front  ( handy_list self, void * item )
+{
+    return handy_mapped_list_add_at( self, item, 0 );
+}
+bool   handy_mapped_list_add_back   ( handy_list self, void * item )
+{
+    return handy_mapped_list_add_at( self, item, self->_size );
+}
+bool   handy_mapped_list_add_at     ( handy_list self, void * item, int at )
+{
+    if( at < 0 )
+        at = 0;
+    else if( at > self->_size )
+        at = self->_size;
+
+    handy_mapped_list list = (handy_mapped_list) self;
+
+    return handy_mapped_insert( list, item, self->_reversed ? (uint64_t)( self->_size - at ) : (uint64_t) at );
+}
+bool   handy_mapped_list_empty      ( handy_list self )
+{
+    return self->_size == 0 ? true : false;
+}
+void * handy_mapped_list_get_front  ( handy_list self )
+{
+    return handy_mapped_list_get_at( self, 0 );
+}
+void * handy_mapped_list_get_back   ( handy_list self )
+{
+    return handy_mapped_list_get_at( self, self->_size - 1 );
+}
+void * handy_mapped_list_get_at     ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return NULL;
+
+    handy_mapped_list list = (handy_mapped_list) self;
+    uint64_t          slot = handy_mapped_slot_at( list, handy_mapped_pos( list, at ) );
+
+    return (void *)(uintptr_t) handy_mapped_node( list, slot )->_data;
+}
+bool   handy_mapped_list_rem_front  ( handy_list self )
+{
+    return handy_mapped_list_rem_at( self, 0 );
+}
+bool   handy_mapped_list_rem_back   ( handy_list self )
+{
+    return handy_mapped_list_rem_at( self, self->_size - 1 );
+}
+bool   handy_mapped_list_rem_at     ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return false;
+
+    handy_mapped_list list = (handy_mapped_list) self;
+
+    handy_mapped_unlink( list, handy_mapped_slot_at( list, handy_mapped_pos( list, at ) ) );
+    return true;
+}
+void   handy_mapped_list_reverse    ( handy_list self )
+{
+    handy_mapped_list list = (handy_mapped_list) self;
+
+    self->_reversed = !self->_reversed;
+    list->_header->_reversed = self->_reversed;
+}
+void   handy_mapped_list_free       ( handy_list self )
+{
+    // the items stay in the file; the mapping goes and the list carries
+    // on as an empty node list, which holds nothing until it is used
+    handy_mapped_list list = (handy_mapped_list) self;
+
+    msync( list->_header, list->_map_bytes, MS_SYNC );
+    munmap( list->_header, list->_map_bytes );
+    close( list->_fd );
+
+#ifdef HANDY_LIST_STATS
+    struct handy_list_stats stats = self->_stats;
+#endif
+
+    handy_list_init_header( self, &handy_node_list_ops );
+
+#ifdef HANDY_LIST_STATS
+    self->_stats = stats;
+#endif
+}
+int    handy_mapped_list_length     ( handy_list self )
+{
+    return self->_size;
+}
@@ -0,0 +1,317 @@
+// persistent list: a version is two immutable chains of shared nodes
+//
+// _front holds the first items in order and _back the rest newest first,
+// so both ends grow by one new node pointing at the old chain. A node
+// counts the versions and nodes pointing at it and goes once that count
+// drops to zero. The ends are cached in the version, so get_front and
+// get_back never walk. A removal that empties one chain splits the other
+// in half, so removals are O(1) amortized from either end.
+//
+// Nodes may be freed on another thread than the one that made them, so
+// they come from malloc rather than the thread-local handy_list pool.
+
+#include "handy_plist.h"
+
+#include <stdatomic.h>
+
+typedef struct __handy_pnode * _handy_pnode;
+
+struct __handy_pnode
+{
+    void *       _data;
+    _handy_pnode _next;
+    atomic_int   _refs;
+};
+
+struct _handy_plist_struct
+{
+    _handy_pnode _front;            // first items, in order
+    _handy_pnode _back;             // remaining items, newest first
+    int          _front_size;
+    int          _back_size;
+
+    void *       _first;            // cached ends
+    void *       _last;
+
+    atomic_int   _refs;
+};
+
+static _handy_pnode handy_pnode_retain  ( _handy_pnode node )
+{
+    if( node != NULL )
+        atomic_fetch_add_explicit( &node->_refs, 1, memory_order_relaxed );
+    return node;
+}
+static void handy_pnode_release         ( _handy_pnode node )
+{
+    // iterative, so dropping a long unshared chain does not recurse
+    while( node != NULL && atomic_fetch_sub_explicit( &node->_refs, 1, memory_order_acq_rel ) == 1 )
+    {
+        _handy_pnode next = node->_next;
+        free( node );
+        node = next;
+    }
+}
+// new node holding item in front of next; takes over a reference to next
+static _handy_pnode handy_pnode_new     ( void * item, _handy_pnode next )
+{
+    _handy_pnode temp = malloc( sizeof( *temp ) );
+    if( temp == NULL )
+        return NULL;
+
+    temp->_data = item;
+    temp->_next = next;
+    atomic_init( &temp->_refs, 1 );
+
+    return temp;
+}
+// rebuild chain ( n nodes ) when the other end has run out: without its
+// last node if drop, the first half stays as it is and the rest is turned
+// round for the other end. Both halves are copies, so the old version is
+// untouched, and half of the items must go before either end runs out
+// again, which pays for the copy. NULL halves when nothing is left, false
+// when out of memory
+static bool handy_pnode_split           ( _handy_pnode chain, int n, bool drop, _handy_pnode * kept, _handy_pnode * turned )
+{
+    int            count = n - ( drop ? 1 : 0 );
+    int            keep  = count / 2;
+    _handy_pnode   head  = NULL;
+    _handy_pnode * link  = &head;
+    _handy_pnode   temp  = NULL;
+
+    for( int i = 0; i < count; i++, chain = chain->_next )
+    {
+        _handy_pnode node = handy_pnode_new( chain->_data, i < keep ? NULL : temp );
+        if( node == NULL )
+        {
+            handy_pnode_release( head );
+            handy_pnode_release( temp );
+            return false;
+        }
+
+        if( i < keep )
+        {
+            *link = node;
+            link = &node->_next;
+        }
+        else
+            temp = node;
+    }
+    *kept = head;
+    *turned = temp;
+    return true;
+}
+// new version; takes over one reference to each chain
+static handy_plist handy_plist_new      ( _handy_pnode front, int front_size, _handy_pnode back, int back_size,
+                                          void * first, void * last )
+{
+    handy_plist temp_list = malloc( sizeof( *temp_list ) );
+    if( temp_list == NULL )
+    {
+        handy_pnode_release( front );
+        handy_pnode_release( back );
+        return NULL;
+    }
+
+    temp_list->_front = front;
+    temp_list->_back = back;
+    temp_list->_front_size = front_size;
+    temp_list->_back_size = back_size;
+    temp_list->_first = first;
+    temp_list->_last = last;
+    atomic_init( &temp_list->_refs, 1 );
+
+    return temp_list;
+}
+
+handy_plist handy_create_plist  ()
+{
+    return handy_plist_new( NULL, 0, NULL, 0, NULL, NULL );
+}
+handy_plist handy_plist_add_front ( handy_plist self, void * item )
+{
+    _handy_pnode node = handy_pnode_new( item, handy_pnode_retain( self->_front ) );
+    if( node == NULL )
+    {
+        handy_pnode_release( self->_front );
+        return NULL;
+    }
+
+    return handy_plist_new( node, self->_front_size + 1, handy_pnode_retain( self->_back ), self->_back_size,
+                            item, handy_plist_empty( self ) ? item : self->_last );
+}
+handy_plist handy_plist_add_back  ( handy_plist self, void * item )
+{
+    _handy_pnode node = handy_pnode_new( item, handy_pnode_retain( self->_back ) );
+    if( node == NULL )
+    {
+        handy_pnode_release( self->_back );
+        return NULL;
+    }
+
+    return handy_plist_new( handy_pnode_retain( self->_front ), self->_front_size, node, self->_back_size + 1,
+                            handy_plist_empty( self ) ? item : self->_first, item );
+}
+handy_plist handy_plist_rem_front ( handy_plist self )
+{
+    int          left = handy_plist_length( self ) - 1;
+    _handy_pnode front;
+    _handy_pnode back;
+    int          back_size = self->_back_size;
+
+    if( left < 0 )
+        return NULL;
+
+    if( self->_front_size > 1 || self->_back_size == 0 )
+    {
+        front = handy_pnode_retain( self->_front->_next );
+        back = handy_pnode_retain( self->_back );
+    }
+    else
+    {
+        // _front runs out: the half of _back nearer the front, less the
+        // front item when _front had none, becomes the new front
+        if( !handy_pnode_split( self->_back, self->_back_size, self->_front_size == 0, &back, &front ) )
+            return NULL;
+        back_size = ( self->_back_size - ( self->_front_size == 0 ? 1 : 0 ) ) / 2;
+    }
+
+    // what is left always starts on _front
+    return handy_plist_new( front, left - back_size, back, back_size,
+                            left > 0 ? front->_data : NULL, left > 0 ? self->_last : NULL );
+}
+handy_plist handy_plist_rem_back  ( handy_plist self )
+{
+    int          left = handy_plist_length( self ) - 1;
+    _handy_pnode front;
+    _handy_pnode back;
+    int          front_size = self->_front_size;
+
+    if( left < 0 )
+        return NULL;
+
+    if( self->_back_size > 1 || self->_front_size == 0 )
+    {
+        front = handy_pnode_retain( self->_front );
+        back = handy_pnode_retain( self->_back->_next );
+    }
+    else
+    {
+        // _back runs out: the half of _front nearer the back, less the
+        // back item when _back had none, becomes the new back
+        if( !handy_pnode_split( self->_front, self->_front_size, self->_back_size == 0, &front, &back ) )
+            return NULL;
+        front_size = ( self->_front_size - ( self->_back_size == 0 ? 1 : 0 ) ) / 2;
+    }
+
+    // what is left always ends on _back
+    return handy_plist_new( front, front_size, back, left - front_size,
+                            left > 0 ? self->_first : NULL, left > 0 ? back->_data : NULL );
+}
+handy_plist handy_plist_retain    ( handy_plist self )
+{
+    atomic_fetch_add_explicit( &self->_refs, 1, memory_order_relaxed );
+    return self;
+}
+void   handy_plist_release      ( handy_plist self )
+{
+    if( self == NULL || atomic_fetch_sub_explicit( &self->_refs, 1, memory_order_acq_rel ) != 1 )
+        return;
+
+    handy_pnode_release( self->_front );
+    handy_pnode_release( self->_back );
+    free( self );
+}
+int    handy_plist_length       ( handy_plist self )
+{
+    return self->_front_size + self->_back_size;
+}
+bool   handy_plist_empty        ( handy_plist self )
+{
+    return handy_plist_length( self ) == 0;
+}
+void * handy_plist_get_front    ( handy_plist self )
+{
+    return self->_first;
+}
+void * handy_plist_get_back     ( handy_plist self )
+{
+    return self->_last;
+}
+void * handy_plist_get_at       ( handy_plist self, int at )
+{
+    _handy_pnode iter;
+
+    if( at < 0 || at >= handy_plist_length( self ) )
+        return NULL;
+
+    if( at < self->_front_size )
+        iter = self->_front;
+    else
+    {
+        // _back counts from the end
+        at = handy_plist_length( self ) - 1 - at;
+        iter = self->_back;
+    }
+
+    for( ; at > 0; at-- )
+        iter = iter->_next;
+    return iter->_data;
+}
+int    handy_plist_contain      ( handy_plist self, void * item )
+{
+    int index = 0;
+
+    for( _handy_pnode iter = self->_front; iter != NULL; iter = iter->_next, index++ )
+    {
+        if( iter->_data == item )
+            return index;
+    }
+
+    // newest first: the earliest match is the last one found
+    int found = -1;
+
+    index = handy_plist_length( self ) - 1;
+    for( _handy_pnode iter = self->_back; iter != NULL; iter = iter->_next, index-- )
+    {
+        if( iter->_data == item )
+            found = index;
+    }
+    return found;
+}
+void   handy_plist_for_each     ( handy_plist self, bool (*visit)( void * item, void * ctx ), void * ctx )
+{
+    for( _handy_pnode iter = self->_front; iter != NULL; iter = iter->_next )
+    {
+        if( !visit( iter->_data, ctx ) )
+            return;
+    }
+
+    if( self->_back_size == 0 )
+        return;
+
+    // _back runs newest first: gather it, then visit it backwards
+    void *  hold[64];
+    void ** items = self->_back_size <= 64 ? hold : malloc( self->_back_size * sizeof( void * ) );
+
+    if( items == NULL )
+    {
+        for( int i = self->_front_size; i < handy_plist_length( self ); i++ )
+        {
+            if( !visit( handy_plist_get_at( self, i ), ctx ) )
+                return;
+        }
+        return;
+    }
+
+    int count = 0;
+
+    for( _handy_pnode iter = self->_back; iter != NULL; iter = iter->_next )
+        items[ count++ ] = iter->_data;
+
+    while( count > 0 && visit( items[ count - 1 ], ctx ) )
+        count--;
+
+    if( items != hold )
+        free( items );
+}
@@ -0,0 +1,57 @@
+// header definition of handy_plist( persistent linked list ) data structure
+//
+// Every version is immutable. add_back, add_front and the removals leave
+// the version they are given alone and return a new one that shares all
+// untouched nodes with it, so keeping a snapshot is O(1): retain the
+// version you have. Versions and nodes are reference counted; release a
+// version once you are done with it.
+//
+// A writer typically keeps one current version and moves it along:
+//
+//     handy_plist next = handy_plist_add_back( cur, item );
+//     handy_plist_release( cur );
+//     cur = next;
+//
+// and hands readers handy_plist_retain( cur ). Readers never lock and
+// never copy, and may release their snapshot on any thread.
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifndef HANDY_PLIST_H
+#define HANDY_PLIST_H
+
+typedef struct _handy_plist_struct * handy_plist;
+
+// a new empty version
+extern handy_plist handy_create_plist();
+
+// new versions, O(1); NULL when out of memory
+extern handy_plist handy_plist_add_front ( handy_plist self, void * item );
+extern handy_plist handy_plist_add_back  ( handy_plist self, void * item );
+// new versions without the front or back item; NULL when self is empty or
+// out of memory. O(1) amortized: when an end runs out, the items held at
+// the other end are copied once and split between the two, after which
+// half of them go before that happens again. Removing over and over from
+// the same old version repeats the copy each time
+extern handy_plist handy_plist_rem_front ( handy_plist self );
+extern handy_plist handy_plist_rem_back  ( handy_plist self );
+
+// take one more reference to self, for a snapshot; returns self
+extern handy_plist handy_plist_retain    ( handy_plist self );
+// drop a reference; the last one frees the version and every node no
+// other version shares
+extern void        handy_plist_release   ( handy_plist self );
+
+extern int    handy_plist_length    ( handy_plist self );
+extern bool   handy_plist_empty     ( handy_plist self );
+extern void * handy_plist_get_front ( handy_plist self );
+extern void * handy_plist_get_back  ( handy_plist self );
+// O(n)
+extern void * handy_plist_get_at    ( handy_plist self, int at );
+extern int    handy_plist_contain   ( handy_plist self, void * item );
+
+// visit every item front to back; visit returns false to stop early
+extern void   handy_plist_for_each  ( handy_plist self, bool (*visit)( void * item, void * ctx ), void * ctx );
+
+#endif //HANDY_PLIST_H
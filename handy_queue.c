@@ -0,0 +1,394 @@
+// Michael-Scott queue with hazard pointers
+//
+// Producers link at the tail and consumers swing the head with CAS. A
+// dequeued node is retired rather than freed: each thread publishes the
+// nodes it is about to touch in hazard slots, and a retired node is only
+// reused once no slot names it. Reclaimed nodes go to a per-thread cache
+// that feeds that thread's next add_back.
+
+#include "handy_queue.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define HANDY_QUEUE_LINE          64
+#define HANDY_HAZARD_SLOTS        2
+#define HANDY_RETIRE_THRESHOLD    128
+#define HANDY_NODE_CACHE_MAX      1024
+
+typedef struct __handy_queue_node * _handy_queue_node;
+
+struct __handy_queue_node
+{
+    _Atomic( _handy_queue_node ) _next;
+    void *                       _data;
+    _handy_queue_node            _spare;    // retired / cached chain, never read by the queue
+};
+
+struct _handy_queue_struct
+{
+    // head and tail on their own lines so producers and consumers do not
+    // share one
+    _Alignas( HANDY_QUEUE_LINE ) _Atomic( _handy_queue_node ) _head;
+    _Alignas( HANDY_QUEUE_LINE ) _Atomic( _handy_queue_node ) _tail;
+    _Alignas( HANDY_QUEUE_LINE ) atomic_long                   _size;
+};
+
+// hazard records are never freed; a thread that exits hands its record
+// back for the next new thread
+typedef struct __handy_hazard * _handy_hazard;
+
+struct __handy_hazard
+{
+    _Atomic( _handy_queue_node ) _slot[ HANDY_HAZARD_SLOTS ];
+    _Atomic( _handy_hazard )     _next;
+    atomic_bool                  _active;
+};
+
+static _Atomic( _handy_hazard ) handy_hazards = NULL;
+static atomic_int               handy_hazard_count = 0;
+
+struct __handy_queue_thread
+{
+    _handy_hazard     _hazard;
+    _handy_queue_node _retired;
+    int               _retired_count;
+    _handy_queue_node _cache;
+    int               _cache_count;
+};
+
+static _Thread_local struct __handy_queue_thread handy_queue_self;
+
+static pthread_key_t  handy_queue_key;
+static pthread_once_t handy_queue_once = PTHREAD_ONCE_INIT;
+
+static void handy_queue_thread_exit ( void * unused );
+
+static void handy_queue_key_init    ()
+{
+    pthread_key_create( &handy_queue_key, handy_queue_thread_exit );
+}
+static _handy_hazard handy_hazard_acquire ()
+{
+    _handy_hazard record = handy_queue_self._hazard;
+
+    if( record != NULL )
+        return record;
+
+    pthread_once( &handy_queue_once, handy_queue_key_init );
+    pthread_setspecific( handy_queue_key, &handy_queue_self );
+
+    // reuse a record left by an exited thread
+    for( record = atomic_load( &handy_hazards ); record != NULL; record = atomic_load( &record->_next ) )
+    {
+        bool idle = false;
+        if( atomic_compare_exchange_strong( &record->_active, &idle, true ) )
+            return handy_queue_self._hazard = record;
+    }
+
+    record = calloc( 1, sizeof( *record ) );
+    if( record == NULL )
+        abort();
+
+    atomic_store( &record->_active, true );
+
+    _handy_hazard head = atomic_load( &handy_hazards );
+    do
+        atomic_store( &record->_next, head );
+    while( !atomic_compare_exchange_weak( &handy_hazards, &head, record ) );
+
+    atomic_fetch_add( &handy_hazard_count, 1 );
+
+    return handy_queue_self._hazard = record;
+}
+static int  handy_hazard_compare    ( const void * a, const void * b )
+{
+    uintptr_t x = (uintptr_t) *(void * const *) a;
+    uintptr_t y = (uintptr_t) *(void * const *) b;
+
+    return x < y ? -1 : x > y;
+}
+static void handy_node_cache_put    ( _handy_queue_node node )
+{
+    if( handy_queue_self._cache_count >= HANDY_NODE_CACHE_MAX )
+    {
+        free( node );
+        return;
+    }
+    node->_spare = handy_queue_self._cache;
+    handy_queue_self._cache = node;
+    handy_queue_self._cache_count++;
+}
+// move every retired node no hazard slot names into the node cache
+static void handy_hazard_scan       ()
+{
+    int     capacity = ( atomic_load( &handy_hazard_count ) + 1 ) * HANDY_HAZARD_SLOTS;
+    void ** guarded = malloc( capacity * sizeof( void * ) );
+    int     count = 0;
+
+    if( guarded == NULL )
+        return;
+
+    for( _handy_hazard record = atomic_load( &handy_hazards ); record != NULL; record = atomic_load( &record->_next ) )
+    {
+        // records may be added while we walk; missing one would be unsafe
+        if( count + HANDY_HAZARD_SLOTS > capacity )
+        {
+            void ** grown = realloc( guarded, 2 * capacity * sizeof( void * ) );
+            if( grown == NULL )
+            {
+                free( guarded );
+                return;
+            }
+            guarded = grown;
+            capacity *= 2;
+        }
+        for( int i = 0; i < HANDY_HAZARD_SLOTS; i++ )
+        {
+            void * node = atomic_load( &record->_slot[i] );
+            if( node != NULL )
+                guarded[ count++ ] = node;
+        }
+    }
+    qsort( guarded, count, sizeof( void * ), handy_hazard_compare );
+
+    _handy_queue_node keep = NULL;
+    int               kept = 0;
+
+    while( handy_queue_self._retired != NULL )
+    {
+        _handy_queue_node node = handy_queue_self._retired;
+        handy_queue_self._retired = node->_spare;
+
+        if( count > 0 && bsearch( &node, guarded, count, sizeof( void * ), handy_hazard_compare ) != NULL )
+        {
+            node->_spare = keep;
+            keep = node;
+            kept++;
+        }
+        else
+            handy_node_cache_put( node );
+    }
+    handy_queue_self._retired = keep;
+    handy_queue_self._retired_count = kept;
+
+    free( guarded );
+}
+static void handy_hazard_retire     ( _handy_queue_node node )
+{
+    node->_spare = handy_queue_self._retired;
+    handy_queue_self._retired = node;
+
+    if( ++handy_queue_self._retired_count >= HANDY_RETIRE_THRESHOLD )
+        handy_hazard_scan();
+}
+static void handy_queue_thread_exit ( void * unused )
+{
+    (void) unused;
+
+    // hazards are only held for the length of one operation, so the
+    // last retired nodes free up quickly
+    while( handy_queue_self._retired != NULL )
+    {
+        handy_hazard_scan();
+        if( handy_queue_self._retired != NULL )
+            sched_yield();
+    }
+    while( handy_queue_self._cache != NULL )
+    {
+        _handy_queue_node next = handy_queue_self._cache->_spare;
+        free( handy_queue_self._cache );
+        handy_queue_self._cache = next;
+    }
+    handy_queue_self._cache_count = 0;
+
+    if( handy_queue_self._hazard != NULL )
+    {
+        for( int i = 0; i < HANDY_HAZARD_SLOTS; i++ )
+            atomic_store( &handy_queue_self._hazard->_slot[i], NULL );
+        atomic_store( &handy_queue_self._hazard->_active, false );
+        handy_queue_self._hazard = NULL;
+    }
+}
+static _handy_queue_node handy_queue_node_get ( void * item )
+{
+    _handy_queue_node node = handy_queue_self._cache;
+
+    if( node != NULL )
+    {
+        handy_queue_self._cache = node->_spare;
+        handy_queue_self._cache_count--;
+    }
+    else
+    {
+        node = malloc( sizeof( *node ) );
+        if( node == NULL )
+            return NULL;
+    }
+
+    atomic_store_explicit( &node->_next, NULL, memory_order_relaxed );
+    node->_data = item;
+    node->_spare = NULL;
+
+    return node;
+}
+// publish src in a hazard slot and confirm it is still current
+static _handy_queue_node handy_hazard_protect ( _handy_hazard record, int slot, _Atomic( _handy_queue_node ) * src )
+{
+    _handy_queue_node node = atomic_load( src );
+
+    for( ;; )
+    {
+        atomic_store( &record->_slot[ slot ], node );
+
+        _handy_queue_node again = atomic_load( src );
+        if( again == node )
+            return node;
+        node = again;
+    }
+}
+
+handy_queue handy_create_queue      ()
+{
+    handy_queue temp_queue = aligned_alloc( HANDY_QUEUE_LINE, sizeof( *temp_queue ) );
+    if( temp_queue == NULL )
+        return NULL;
+
+    _handy_queue_node dummy = malloc( sizeof( *dummy ) );
+    if( dummy == NULL )
+    {
+        free( temp_queue );
+        return NULL;
+    }
+    atomic_init( &dummy->_next, NULL );
+    dummy->_data = NULL;
+    dummy->_spare = NULL;
+
+    atomic_init( &temp_queue->_head, dummy );
+    atomic_init( &temp_queue->_tail, dummy );
+    atomic_init( &temp_queue->_size, 0 );
+
+    return temp_queue;
+}
+bool   handy_queue_add_back         ( handy_queue self, void * item )
+{
+    _handy_hazard     record = handy_hazard_acquire();
+    _handy_queue_node node = handy_queue_node_get( item );
+
+    if( node == NULL )
+        return false;
+
+    for( ;; )
+    {
+        _handy_queue_node tail = handy_hazard_protect( record, 0, &self->_tail );
+        _handy_queue_node next = atomic_load( &tail->_next );
+
+        if( tail != atomic_load( &self->_tail ) )
+            continue;
+
+        if( next != NULL )
+        {
+            // another producer linked but has not swung the tail yet
+            atomic_compare_exchange_weak( &self->_tail, &tail, next );
+            continue;
+        }
+
+        _handy_queue_node expected = NULL;
+        if( atomic_compare_exchange_weak( &tail->_next, &expected, node ) )
+        {
+            atomic_compare_exchange_strong( &self->_tail, &tail, node );
+            break;
+        }
+    }
+    atomic_store( &record->_slot[0], NULL );
+
+    atomic_fetch_add_explicit( &self->_size, 1, memory_order_relaxed );
+    return true;
+}
+// shared by pop_front ( take ) and get_front ( peek )
+static bool handy_queue_front       ( handy_queue self, void ** item, bool take )
+{
+    _handy_hazard     record = handy_hazard_acquire();
+    _handy_queue_node head;
+    void *            data;
+
+    for( ;; )
+    {
+        head = handy_hazard_protect( record, 0, &self->_head );
+
+        _handy_queue_node tail = atomic_load( &self->_tail );
+        _handy_queue_node next = atomic_load( &head->_next );
+
+        atomic_store( &record->_slot[1], next );
+        if( head != atomic_load( &self->_head ) )
+            continue;
+
+        if( next == NULL )
+        {
+            atomic_store( &record->_slot[0], NULL );
+            atomic_store( &record->_slot[1], NULL );
+            return false;
+        }
+
+        data = next->_data;
+
+        if( !take )
+            break;
+
+        if( head == tail )
+        {
+            // the tail lags behind; help it on before moving the head
+            atomic_compare_exchange_weak( &self->_tail, &tail, next );
+            continue;
+        }
+        if( atomic_compare_exchange_weak( &self->_head, &head, next ) )
+            break;
+    }
+    atomic_store( &record->_slot[0], NULL );
+    atomic_store( &record->_slot[1], NULL );
+
+    if( take )
+    {
+        atomic_fetch_sub_explicit( &self->_size, 1, memory_order_relaxed );
+        handy_hazard_retire( head );
+    }
+
+    if( item != NULL )
+        *item = data;
+    return true;
+}
+bool   handy_queue_pop_front        ( handy_queue self, void ** item )
+{
+    return handy_queue_front( self, item, true );
+}
+bool   handy_queue_get_front        ( handy_queue self, void ** item )
+{
+    return handy_queue_front( self, item, false );
+}
+bool   handy_queue_rem_front        ( handy_queue self )
+{
+    return handy_queue_front( self, NULL, true );
+}
+bool   handy_queue_empty            ( handy_queue self )
+{
+    return !handy_queue_get_front( self, NULL );
+}
+long   handy_queue_length           ( handy_queue self )
+{
+    long size = atomic_load_explicit( &self->_size, memory_order_relaxed );
+    return size < 0 ? 0 : size;
+}
+void   handy_queue_free             ( handy_queue self )
+{
+    _handy_queue_node iter = atomic_load( &self->_head );
+
+    while( iter != NULL )
+    {
+        _handy_queue_node next = atomic_load( &iter->_next );
+        free( iter );
+        iter = next;
+    }
+    free( self );
+}
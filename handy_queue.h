@@ -0,0 +1,30 @@
+// header definition of handy_queue( lock-free multi-producer, multi-consumer
+// queue ) data structure
+//
+// Same contract as a handy_list used as a work queue: add_back to produce,
+// get_front / rem_front ( or the combined pop_front ) to consume, from any
+// number of threads without an outside lock.
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifndef HANDY_QUEUE_H
+#define HANDY_QUEUE_H
+
+typedef struct _handy_queue_struct * handy_queue;
+
+extern handy_queue handy_create_queue();
+
+extern bool   handy_queue_add_back  ( handy_queue self, void * item );
+// peek at the front item; false when the queue is empty
+extern bool   handy_queue_get_front ( handy_queue self, void ** item );
+extern bool   handy_queue_rem_front ( handy_queue self );
+// take the front item in one step; false when the queue is empty
+extern bool   handy_queue_pop_front ( handy_queue self, void ** item );
+extern bool   handy_queue_empty     ( handy_queue self );
+// a snapshot; exact only while no other thread is using the queue
+extern long   handy_queue_length    ( handy_queue self );
+// release the queue; no other thread may still be using it
+extern void   handy_queue_free      ( handy_queue self );
+
+#endif //HANDY_QUEUE_H
@@ -0,0 +1,452 @@
+// thread-safe node list behind the handy_list interface
+//
+// The items are kept in two node lists, the front part and the back part,
+// each behind its own reader/writer lock built for read-mostly use:
+// readers count themselves on one of HANDY_SHARED_STRIPES cache lines
+// picked per thread, so readers on different threads never write the same
+// line, and a writer raises the part's writer count and waits for the
+// part's readers on every stripe to drain. length and empty read the
+// header size and take no lock at all.
+//
+// Readers and writers lock only the parts they touch, front before back.
+// Work at the two ends ( a queue's add_back and rem_front ) goes on side by
+// side, and shuts out only the readers of its own end: get_front, and
+// get_at below the front part's size, read the front part alone, get_back
+// the back part alone. A position past the front part is counted from the
+// front part's size, so reading or changing it holds both parts, as do
+// contain, reverse and free. An end that runs dry takes half of the other
+// part, O(1) amortized per removal. Reads never write to the node lists,
+// so a writer has no index state to bring up to date before it lets go.
+
+#include "handy_list.h"
+
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define HANDY_SHARED_STRIPES 64
+#define HANDY_SHARED_LINE    64
+
+// parts a reader or writer locks; bit 1 << i is part i
+#define HANDY_SHARED_FRONT   0x1
+#define HANDY_SHARED_BACK    0x2
+#define HANDY_SHARED_BOTH    ( HANDY_SHARED_FRONT | HANDY_SHARED_BACK )
+
+// one thread's readers of each part
+struct __handy_shared_stripe
+{
+    _Alignas( HANDY_SHARED_LINE ) atomic_int _readers[2];
+};
+
+struct __handy_shared_writers
+{
+    _Alignas( HANDY_SHARED_LINE ) atomic_int _count;
+};
+
+typedef struct _handy_shared_list_struct * handy_shared_list;
+
+struct _handy_shared_list_struct
+{
+    struct _handy_list_struct _base;
+    struct _handy_list_struct _front;   // positions 0 .. _front._size - 1
+    struct _handy_list_struct _back;    // the positions after those
+
+    pthread_mutex_t _front_lock;    // writers of each part; front taken first
+    pthread_mutex_t _back_lock;
+    struct __handy_shared_writers _writers[2];  // front, back
+
+    struct __handy_shared_stripe _stripes[ HANDY_SHARED_STRIPES ];
+};
+
+int    handy_shared_list_contain    ( handy_list self, void * item );
+bool   handy_shared_list_add_front  ( handy_list self, void * item );
+bool   handy_shared_list_add_back   ( handy_list self, void * item );
+bool   handy_shared_list_add_at     ( handy_list self, void * item, int at );
+bool   handy_shared_list_empty      ( handy_list self );
+
+void * handy_shared_list_get_front  ( handy_list self );
+void * handy_shared_list_get_back   ( handy_list self );
+void * handy_shared_list_get_at     ( handy_list self, int at );
+bool   handy_shared_list_rem_front  ( handy_list self );
+bool   handy_shared_list_rem_back   ( handy_list self );
+bool   handy_shared_list_rem_at     ( handy_list self, int at );
+void   handy_shared_list_reverse    ( handy_list self );
+void   handy_shared_list_free       ( handy_list self );
+int    handy_shared_list_length     ( handy_list self );
+
+static const struct _handy_list_ops handy_shared_list_ops =
+{
+    .contain       = handy_shared_list_contain,
+    .add_front     = handy_shared_list_add_front,
+    .add_back      = handy_shared_list_add_back,
+    .add_at        = handy_shared_list_add_at,
+    .empty         = handy_shared_list_empty,
+    .get_front     = handy_shared_list_get_front,
+    .get_back      = handy_shared_list_get_back,
+    .get_at        = handy_shared_list_get_at,
+    .rem_front     = handy_shared_list_rem_front,
+    .rem_back      = handy_shared_list_rem_back,
+    .reverse       = handy_shared_list_reverse,
+    .rem_at        = handy_shared_list_rem_at,
+    .free          = handy_shared_list_free,
+    .length        = handy_shared_list_length,
+};
+
+handy_list handy_create_shared_list ( unsigned flags )
+{
+    handy_shared_list temp_list = aligned_alloc( HANDY_SHARED_LINE, sizeof(*temp_list) );
+    if( temp_list == NULL )
+        return NULL;
+
+    handy_list_init_header( &temp_list->_base, &handy_shared_list_ops );
+    handy_list_init_header( &temp_list->_front, &handy_node_list_ops );
+    handy_list_init_header( &temp_list->_back, &handy_node_list_ops );
+    temp_list->_front._flags = flags;
+    temp_list->_back._flags = flags;
+
+    pthread_mutex_init( &temp_list->_front_lock, NULL );
+    pthread_mutex_init( &temp_list->_back_lock, NULL );
+    for( int part = 0; part < 2; part++ )
+    {
+        atomic_init( &temp_list->_writers[part]._count, 0 );
+        for( int i = 0; i < HANDY_SHARED_STRIPES; i++ )
+            atomic_init( &temp_list->_stripes[i]._readers[part], 0 );
+    }
+
+    return &temp_list->_base;
+}
+
+static atomic_int           handy_shared_next_stripe = 0;
+static _Thread_local int    handy_shared_stripe = -1;
+
+// a reader already holding the front part may add the back part; never
+// the other way round
+static struct __handy_shared_stripe * handy_shared_read_lock ( handy_shared_list self, unsigned parts )
+{
+    if( handy_shared_stripe < 0 )
+        handy_shared_stripe = atomic_fetch_add( &handy_shared_next_stripe, 1 ) % HANDY_SHARED_STRIPES;
+
+    struct __handy_shared_stripe * stripe = &self->_stripes[ handy_shared_stripe ];
+
+    for( int part = 0; part < 2; part++ )
+    {
+        if( ( parts & ( 1u << part ) ) == 0 )
+            continue;
+
+        atomic_int * readers = &stripe->_readers[part];
+        atomic_int * writers = &self->_writers[part]._count;
+
+        for( ;; )
+        {
+            // announce first, then look for a writer; the writer does the
+            // mirror image, so one of the two always sees the other
+            atomic_fetch_add( readers, 1 );
+            if( atomic_load( writers ) == 0 )
+                break;
+
+            atomic_fetch_sub( readers, 1 );
+            while( atomic_load_explicit( writers, memory_order_relaxed ) != 0 )
+                sched_yield();
+        }
+    }
+    return stripe;
+}
+static void handy_shared_read_unlock ( struct __handy_shared_stripe * stripe, unsigned parts )
+{
+    for( int part = 0; part < 2; part++ )
+    {
+        if( parts & ( 1u << part ) )
+            atomic_fetch_sub_explicit( &stripe->_readers[part], 1, memory_order_release );
+    }
+}
+static void handy_shared_write_lock  ( handy_shared_list self, unsigned parts )
+{
+    // one part after the other: a reader of the front part may be waiting
+    // for the back part, and must get it before the front part drains
+    for( int part = 0; part < 2; part++ )
+    {
+        if( ( parts & ( 1u << part ) ) == 0 )
+            continue;
+
+        pthread_mutex_lock( part == 0 ? &self->_front_lock : &self->_back_lock );
+        atomic_fetch_add( &self->_writers[part]._count, 1 );
+
+        for( int i = 0; i < HANDY_SHARED_STRIPES; i++ )
+        {
+            while( atomic_load( &self->_stripes[i]._readers[part] ) != 0 )
+                sched_yield();
+        }
+    }
+}
+// added is the number of items the writer added less those it removed
+static void handy_shared_write_unlock ( handy_shared_list self, unsigned parts, int added )
+{
+    // publish the size for the lock-free length and empty; writers of the
+    // two parts can finish together, so each adds its own change
+    if( added != 0 )
+        __atomic_fetch_add( &self->_base._size, added, __ATOMIC_RELEASE );
+
+    if( parts & HANDY_SHARED_BACK )
+    {
+        atomic_fetch_sub( &self->_writers[1]._count, 1 );
+        pthread_mutex_unlock( &self->_back_lock );
+    }
+    if( parts & HANDY_SHARED_FRONT )
+    {
+        atomic_fetch_sub( &self->_writers[0]._count, 1 );
+        pthread_mutex_unlock( &self->_front_lock );
+    }
+}
+// the parts position at falls in. The front part's size only changes
+// under its lock; a writer that finds it changed once it holds the parts
+// asks again
+static unsigned handy_shared_parts_at ( handy_shared_list self, int at, bool add )
+{
+    pthread_mutex_lock( &self->_front_lock );
+    bool front = add ? at <= self->_front._size : at < self->_front._size;
+    pthread_mutex_unlock( &self->_front_lock );
+
+    return front ? HANDY_SHARED_FRONT : HANDY_SHARED_BOTH;
+}
+// with both parts locked: move half of the other part into empty
+static void handy_shared_refill      ( handy_shared_list self, handy_list empty )
+{
+    handy_list full = empty == &self->_front ? &self->_back : &self->_front;
+    int        keep = empty == &self->_front ? ( full->_size + 1 ) / 2 : full->_size / 2;
+    handy_list rest = handy_list_split_at( full, keep );
+
+    if( rest == NULL )
+    {
+        // no memory for the split: move all of it
+        handy_list_splice( empty, 0, full );
+        return;
+    }
+
+    if( empty == &self->_front )
+    {
+        // the front takes the first half and the back keeps the rest
+        handy_list_splice( empty, 0, full );
+        handy_list_splice( full, 0, rest );
+    }
+    else
+        handy_list_splice( empty, 0, rest );
+
+    free( rest );
+}
+
+int    handy_shared_list_contain    ( handy_list self, void * item )
+{
+    handy_shared_list              list = (handy_shared_list) self;
+    struct __handy_shared_stripe * lock = handy_shared_read_lock( list, HANDY_SHARED_BOTH );
+
+    int index = handy_list_contain( &list->_front, item );
+    if( index < 0 )
+    {
+        index = handy_list_contain( &list->_back, item );
+        if( index >= 0 )
+            index += list->_front._size;
+    }
+
+    handy_shared_read_unlock( lock, HANDY_SHARED_BOTH );
+    return index;
+}
+bool   handy_shared_list_add_front  ( handy_list self, void * item )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    handy_shared_write_lock( list, HANDY_SHARED_FRONT );
+
+    bool done = handy_list_add_front( &list->_front, item );
+
+    handy_shared_write_unlock( list, HANDY_SHARED_FRONT, done );
+    return done;
+}
+bool   handy_shared_list_add_back   ( handy_list self, void * item )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    handy_shared_write_lock( list, HANDY_SHARED_BACK );
+
+    bool done = handy_list_add_back( &list->_back, item );
+
+    handy_shared_write_unlock( list, HANDY_SHARED_BACK, done );
+    return done;
+}
+bool   handy_shared_list_add_at     ( handy_list self, void * item, int at )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    unsigned          parts = handy_shared_parts_at( list, at, true );
+    bool              done;
+
+    handy_shared_write_lock( list, parts );
+
+    if( at <= list->_front._size )
+        done = handy_list_add_at( &list->_front, item, at );
+    else if( parts == HANDY_SHARED_BOTH )
+        done = handy_list_add_at( &list->_back, item, at - list->_front._size );
+    else
+    {
+        handy_shared_write_unlock( list, parts, 0 );
+        return handy_shared_list_add_at( self, item, at );
+    }
+
+    handy_shared_write_unlock( list, parts, done );
+    return done;
+}
+bool   handy_shared_list_empty      ( handy_list self )
+{
+    return __atomic_load_n( &self->_size, __ATOMIC_ACQUIRE ) == 0;
+}
+void * handy_shared_list_get_front  ( handy_list self )
+{
+    handy_shared_list              list  = (handy_shared_list) self;
+    unsigned                       parts = HANDY_SHARED_FRONT;
+    struct __handy_shared_stripe * lock  = handy_shared_read_lock( list, parts );
+    void *                         item;
+
+    if( list->_front._size > 0 )
+        item = handy_list_get_front( &list->_front );
+    else
+    {
+        // the front part is empty, and stays so while it is held
+        handy_shared_read_lock( list, HANDY_SHARED_BACK );
+        parts = HANDY_SHARED_BOTH;
+        item = handy_list_get_front( &list->_back );
+    }
+
+    handy_shared_read_unlock( lock, parts );
+    return item;
+}
+void * handy_shared_list_get_back   ( handy_list self )
+{
+    handy_shared_list              list  = (handy_shared_list) self;
+    unsigned                       parts = HANDY_SHARED_BACK;
+    struct __handy_shared_stripe * lock  = handy_shared_read_lock( list, parts );
+
+    if( list->_back._size == 0 )
+    {
+        // the front part goes first: come back for both
+        handy_shared_read_unlock( lock, parts );
+        handy_shared_read_lock( list, parts = HANDY_SHARED_BOTH );
+    }
+
+    void * item = list->_back._size > 0 ? handy_list_get_back( &list->_back )
+                                        : handy_list_get_back( &list->_front );
+
+    handy_shared_read_unlock( lock, parts );
+    return item;
+}
+void * handy_shared_list_get_at     ( handy_list self, int at )
+{
+    handy_shared_list              list  = (handy_shared_list) self;
+    unsigned                       parts = HANDY_SHARED_FRONT;
+    struct __handy_shared_stripe * lock  = handy_shared_read_lock( list, parts );
+    void *                         item;
+
+    if( at < list->_front._size )
+        item = handy_list_get_at( &list->_front, at );
+    else
+    {
+        // positions in the back part count from the front part's size
+        handy_shared_read_lock( list, HANDY_SHARED_BACK );
+        parts = HANDY_SHARED_BOTH;
+        item = handy_list_get_at( &list->_back, at - list->_front._size );
+    }
+
+    handy_shared_read_unlock( lock, parts );
+    return item;
+}
+bool   handy_shared_list_rem_front  ( handy_list self )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    unsigned          parts = HANDY_SHARED_FRONT;
+
+    handy_shared_write_lock( list, parts );
+
+    if( list->_front._size == 0 )
+    {
+        // the front part ran dry: come back for both parts
+        handy_shared_write_unlock( list, parts, 0 );
+        handy_shared_write_lock( list, parts = HANDY_SHARED_BOTH );
+
+        if( list->_front._size == 0 )
+            handy_shared_refill( list, &list->_front );
+    }
+
+    bool done = handy_list_rem_front( &list->_front );
+
+    handy_shared_write_unlock( list, parts, -done );
+    return done;
+}
+bool   handy_shared_list_rem_back   ( handy_list self )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    unsigned          parts = HANDY_SHARED_BACK;
+
+    handy_shared_write_lock( list, parts );
+
+    if( list->_back._size == 0 )
+    {
+        handy_shared_write_unlock( list, parts, 0 );
+        handy_shared_write_lock( list, parts = HANDY_SHARED_BOTH );
+
+        if( list->_back._size == 0 )
+            handy_shared_refill( list, &list->_back );
+    }
+
+    bool done = handy_list_rem_back( &list->_back );
+
+    handy_shared_write_unlock( list, parts, -done );
+    return done;
+}
+bool   handy_shared_list_rem_at     ( handy_list self, int at )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    unsigned          parts = handy_shared_parts_at( list, at, false );
+    bool              done;
+
+    handy_shared_write_lock( list, parts );
+
+    if( at < list->_front._size )
+        done = handy_list_rem_at( &list->_front, at );
+    else if( parts == HANDY_SHARED_BOTH )
+        done = handy_list_rem_at( &list->_back, at - list->_front._size );
+    else
+    {
+        handy_shared_write_unlock( list, parts, 0 );
+        return handy_shared_list_rem_at( self, at );
+    }
+
+    handy_shared_write_unlock( list, parts, -done );
+    return done;
+}
+void   handy_shared_list_reverse    ( handy_list self )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    handy_shared_write_lock( list, HANDY_SHARED_BOTH );
+
+    // turn both parts round and trade them
+    struct _handy_list_struct hold = list->_front;
+
+    handy_list_reverse( &list->_back );
+    handy_list_reverse( &hold );
+
+    list->_front = list->_back;
+    list->_back = hold;
+
+    handy_shared_write_unlock( list, HANDY_SHARED_BOTH, 0 );
+}
+void   handy_shared_list_free       ( handy_list self )
+{
+    handy_shared_list list = (handy_shared_list) self;
+    handy_shared_write_lock( list, HANDY_SHARED_BOTH );
+
+    int size = list->_front._size + list->_back._size;
+
+    handy_list_free( &list->_front );
+    handy_list_free( &list->_back );
+
+    handy_shared_write_unlock( list, HANDY_SHARED_BOTH, -size );
+}
+int    handy_shared_list_length     ( handy_list self )
+{
+    return __atomic_load_n( &self->_size, __ATOMIC_ACQUIRE );
+}
@@ -0,0 +1,216 @@
+// small-size implementation of the handy_list interface
+//
+// Up to HANDY_SMALL_ITEMS items live in an array right behind the list
+// header, in the same allocation, so a short list costs one allocation:
+// 64 bytes of header and 64 of items, two cache lines it starts on the
+// first of ( four with HANDY_LIST_STATS, which makes the header longer ).
+// The header's _flags hold the flags given at creation until the list
+// spills: adding past HANDY_SMALL_ITEMS moves the items into nodes and
+// re-points the header at the node list operations, after which the list
+// is a node list in every respect and the flags apply. A spilled list
+// stays spilled.
+
+#include "handy_list.h"
+
+typedef struct _handy_small_list_struct * handy_small_list;
+
+struct _handy_small_list_struct
+{
+    struct _handy_list_struct _base;    // _flags: node list flags once spilled
+
+    void * _items[ HANDY_SMALL_ITEMS ];
+};
+
+int    handy_small_list_contain     ( handy_list self, void * item );
+bool   handy_small_list_add_front   ( handy_list self, void * item );
+bool   handy_small_list_add_back    ( handy_list self, void * item );
+bool   handy_small_list_add_at      ( handy_list self, void * item, int at );
+bool   handy_small_list_empty       ( handy_list self );
+
+void * handy_small_list_get_front   ( handy_list self );
+void * handy_small_list_get_back    ( handy_list self );
+void * handy_small_list_get_at      ( handy_list self, int at );
+bool   handy_small_list_rem_front   ( handy_list self );
+bool   handy_small_list_rem_back    ( handy_list self );
+bool   handy_small_list_rem_at      ( handy_list self, int at );
+void   handy_small_list_reverse     ( handy_list self );
+void   handy_small_list_free        ( handy_list self );
+int    handy_small_list_length      ( handy_list self );
+
+static const struct _handy_list_ops handy_small_list_ops =
+{
+    .contain       = handy_small_list_contain,
+    .add_front     = handy_small_list_add_front,
+    .add_back      = handy_small_list_add_back,
+    .add_at        = handy_small_list_add_at,
+    .empty         = handy_small_list_empty,
+    .get_front     = handy_small_list_get_front,
+    .get_back      = handy_small_list_get_back,
+    .get_at        = handy_small_list_get_at,
+    .rem_front     = handy_small_list_rem_front,
+    .rem_back      = handy_small_list_rem_back,
+    .reverse       = handy_small_list_reverse,
+    .rem_at        = handy_small_list_rem_at,
+    .free          = handy_small_list_free,
+    .length        = handy_small_list_length,
+};
+
+handy_list handy_create_small_list  ( unsigned flags )
+{
+    // line aligned, so the items share no line with anything else
+    size_t           bytes = ( sizeof(struct _handy_small_list_struct) + 63 ) & ~(size_t) 63;
+    handy_small_list temp_list = aligned_alloc( 64, bytes );
+    if( temp_list == NULL )
+        return NULL;
+
+    handy_list_init_header( &temp_list->_base, &handy_small_list_ops );
+    temp_list->_base._flags = flags;
+
+    return &temp_list->_base;
+}
+
+// move the items into nodes and turn self into a node list; on failure
+// self is left as it was
+static bool handy_small_spill           ( handy_small_list self )
+{
+    handy_list header = &self->_base;
+    int        size = header->_size;
+    unsigned   flags = header->_flags;
+    void *     items[ HANDY_SMALL_ITEMS ];
+
+    // the node list shares the header, so take the items out of the way
+    for( int i = 0; i < size; i++ )
+        items[i] = handy_small_list_get_at( header, i );
+
+#ifdef HANDY_LIST_STATS
+    struct handy_list_stats stats = header->_stats;
+#endif
+
+    handy_list_init_header( header, &handy_node_list_ops );
+    header->_flags = flags;
+
+#ifdef HANDY_LIST_STATS
+    header->_stats = stats;
+#endif
+
+    for( int i = 0; i < size; i++ )
+    {
+        if( !handy_node_list_ops.add_back( header, items[i] ) )
+        {
+            handy_node_list_ops.free( header );
+            handy_list_init_header( header, &handy_small_list_ops );
+            header->_flags = flags;
+#ifdef HANDY_LIST_STATS
+            header->_stats = stats;
+#endif
+            memcpy( self->_items, items, size * sizeof(void *) );
+            header->_size = size;
+            return false;
+        }
+    }
+    return true;
+}
+// physical slot of logical position at
+static inline int handy_small_slot      ( handy_list self, int at )
+{
+    return self->_reversed ? self->_size - 1 - at : at;
+}
+
+int    handy_small_list_contain     ( handy_list self, void * item )
+{
+    void ** items = ((handy_small_list) self)->_items;
+
+    for( int i = 0; i < self->_size; i++ )
+    {
+        if( items[ handy_small_slot( self, i ) ] == item )
+            return i;
+    }
+    return -1;
+}
+bool   handy_small_list_add_front   ( handy_list self, void * item )
+{
+    return handy_small_list_add_at( self, item, 0 );
+}
+bool   handy_small_list_add_back    ( handy_list self, void * item )
+{
+    return handy_small_list_add_at( self, item, self->_size );
+}
+bool   handy_small_list_add_at      ( handy_list self, void * item, int at )
+{
+    handy_small_list list = (handy_small_list) self;
+
+    if( self->_size == HANDY_SMALL_ITEMS )
+    {
+        if( !handy_small_spill( list ) )
+            return false;
+        return self->_ops->add_at( self, item, at );
+    }
+
+    if( at < 0 )
+        at = 0;
+    else if( at > self->_size )
+        at = self->_size;
+
+    // slot the item goes to in physical order
+    int slot = self->_reversed ? self->_size - at : at;
+
+    memmove( list->_items + slot + 1, list->_items + slot, ( self->_size - slot ) * sizeof(void *) );
+    list->_items[ slot ] = item;
+
+    self->_size++;
+    return true;
+}
+bool   handy_small_list_empty       ( handy_list self )
+{
+    return self->_size == 0 ? true : false;
+}
+void * handy_small_list_get_front   ( handy_list self )
+{
+    return handy_small_list_get_at( self, 0 );
+}
+void * handy_small_list_get_back    ( handy_list self )
+{
+    return handy_small_list_get_at( self, self->_size - 1 );
+}
+void * handy_small_list_get_at      ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return NULL;
+
+    return ((handy_small_list) self)->_items[ handy_small_slot( self, at ) ];
+}
+bool   handy_small_list_rem_front   ( handy_list self )
+{
+    return handy_small_list_rem_at( self, 0 );
+}
+bool   handy_small_list_rem_back    ( handy_list self )
+{
+    return handy_small_list_rem_at( self, self->_size - 1 );
+}
+bool   handy_small_list_rem_at      ( handy_list self, int at )
+{
+    if( at < 0 || at >= self->_size )
+        return false;
+
+    handy_small_list list = (handy_small_list) self;
+    int              slot = handy_small_slot( self, at );
+
+    memmove( list->_items + slot, list->_items + slot + 1, ( self->_size - slot - 1 ) * sizeof(void *) );
+
+    self->_size--;
+    return true;
+}
+void   handy_small_list_reverse     ( handy_list self )
+{
+    self->_reversed = !self->_reversed;
+}
+void   handy_small_list_free        ( handy_list self )
+{
+    // the items share the header's allocation: nothing of its own to free
+    self->_size = 0;
+    self->_reversed = false;
+}
+int    handy_small_list_length      ( handy_list self )
+{
+    return self->_size;
+}
@@ -0,0 +1,5 @@
+// typed lists instantiated for the payload types used across the project
+
+#include "handy_tlist.h"
+
+HANDY_LIST_DEFINE( int, int )
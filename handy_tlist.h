@@ -0,0 +1,203 @@
+// header definition of handy_tlist( typed linked list ) generator
+//
+// HANDY_LIST_DECLARE( T, name ) declares handy_list_name, a doubly linked
+// list whose nodes hold values of type T themselves rather than pointers
+// to them, with accessors that take and return T. HANDY_LIST_DEFINE( T,
+// name ) emits its functions and goes in exactly one translation unit.
+// The list is a node list from handy_list.h with each value stored in the
+// node's item word, so it shares the node pool, the one-block add_back_n
+// and the O(1) reverse; T must therefore fit in a pointer. contain
+// compares with the comparator given at creation ( zero meaning equal,
+// like strcmp ); without one, values are equal when their bytes are,
+// which suits scalar types. handy_tlist.c defines handy_list_int.
+
+#include "handy_list.h"
+
+#ifndef HANDY_TLIST_H
+#define HANDY_TLIST_H
+
+// items add_back_n boxes on the stack before linking them
+#define HANDY_TLIST_BATCH 64
+
+#define HANDY_LIST_DECLARE( T, name )                                               \
+                                                                                    \
+_Static_assert( sizeof( T ) <= sizeof( void * ), "handy_list_" #name ": values must fit in a pointer" ); \
+                                                                                    \
+typedef struct _handy_list_##name##_struct * handy_list_##name;                     \
+                                                                                    \
+struct _handy_list_##name##_struct                                                  \
+{                                                                                   \
+    struct _handy_list_struct _base;    /* node list, values in the item words */   \
+                                                                                    \
+    int (*_compare)( T a, T b );                                                    \
+};                                                                                  \
+                                                                                    \
+/* compare may be NULL */                                                           \
+extern handy_list_##name handy_create_list_##name( int (*compare)( T a, T b ) );    \
+                                                                                    \
+extern bool handy_list_##name##_add_front ( handy_list_##name self, T item );       \
+extern bool handy_list_##name##_add_back  ( handy_list_##name self, T item );       \
+extern bool handy_list_##name##_add_at    ( handy_list_##name self, T item, int at ); \
+/* append count items, linked in blocks; all or, out of memory, none */            \
+extern bool handy_list_##name##_add_back_n( handy_list_##name self, const T * items, int count ); \
+/* false, leaving *out alone, when at is not a position of the list */              \
+extern bool handy_list_##name##_get_at    ( handy_list_##name self, int at, T * out ); \
+extern bool handy_list_##name##_rem_front ( handy_list_##name self );               \
+extern bool handy_list_##name##_rem_back  ( handy_list_##name self );               \
+extern bool handy_list_##name##_rem_at    ( handy_list_##name self, int at );       \
+/* copy the last count items ( fewer if the list is shorter ) to out, oldest        \
+   first; returns how many. O(count) */                                             \
+extern int  handy_list_##name##_tail      ( handy_list_##name self, T * out, int count ); \
+/* position of the first item equal to item, or -1 */                               \
+extern int  handy_list_##name##_contain   ( handy_list_##name self, T item );       \
+extern void handy_list_##name##_reverse   ( handy_list_##name self );               \
+extern void handy_list_##name##_free      ( handy_list_##name self );               \
+                                                                                    \
+/* a value in an item word and back; the bytes past T stay zero */                  \
+static inline void * handy_list_##name##_box   ( T item )                           \
+{                                                                                   \
+    void * word = NULL;                                                             \
+                                                                                    \
+    memcpy( &word, &item, sizeof( T ) );                                            \
+    return word;                                                                    \
+}                                                                                   \
+static inline T      handy_list_##name##_unbox ( void * word )                      \
+{                                                                                   \
+    T item;                                                                         \
+                                                                                    \
+    memcpy( &item, &word, sizeof( T ) );                                            \
+    return item;                                                                    \
+}                                                                                   \
+static inline int  handy_list_##name##_length    ( handy_list_##name self )         \
+{                                                                                   \
+    return handy_list_length( &self->_base );                                       \
+}                                                                                   \
+static inline bool handy_list_##name##_empty     ( handy_list_##name self )         \
+{                                                                                   \
+    return handy_list_empty( &self->_base );                                        \
+}                                                                                   \
+/* false, leaving *out alone, when the list is empty */                             \
+static inline bool handy_list_##name##_get_front ( handy_list_##name self, T * out ) \
+{                                                                                   \
+    if( handy_list_empty( &self->_base ) )                                          \
+        return false;                                                               \
+                                                                                    \
+    *out = handy_list_##name##_unbox( handy_list_get_front( &self->_base ) );       \
+    return true;                                                                    \
+}                                                                                   \
+static inline bool handy_list_##name##_get_back  ( handy_list_##name self, T * out ) \
+{                                                                                   \
+    if( handy_list_empty( &self->_base ) )                                          \
+        return false;                                                               \
+                                                                                    \
+    *out = handy_list_##name##_unbox( handy_list_get_back( &self->_base ) );        \
+    return true;                                                                    \
+}
+
+#define HANDY_LIST_DEFINE( T, name )                                                \
+                                                                                    \
+handy_list_##name handy_create_list_##name ( int (*compare)( T a, T b ) )           \
+{                                                                                   \
+    handy_list_##name temp_list = malloc( sizeof(*temp_list) );                     \
+    if( temp_list == NULL )                                                         \
+        return NULL;                                                                \
+                                                                                    \
+    handy_list_init_header( &temp_list->_base, &handy_node_list_ops );              \
+    temp_list->_compare = compare;                                                  \
+                                                                                    \
+    return temp_list;                                                               \
+}                                                                                   \
+bool handy_list_##name##_add_front  ( handy_list_##name self, T item )              \
+{                                                                                   \
+    return handy_list_add_front( &self->_base, handy_list_##name##_box( item ) );   \
+}                                                                                   \
+bool handy_list_##name##_add_back   ( handy_list_##name self, T item )              \
+{                                                                                   \
+    return handy_list_add_back( &self->_base, handy_list_##name##_box( item ) );    \
+}                                                                                   \
+bool handy_list_##name##_add_at     ( handy_list_##name self, T item, int at )      \
+{                                                                                   \
+    return handy_list_add_at( &self->_base, handy_list_##name##_box( item ), at );  \
+}                                                                                   \
+bool handy_list_##name##_add_back_n ( handy_list_##name self, const T * items, int count ) \
+{                                                                                   \
+    /* boxed a batch at a time, each batch linked as one block of nodes */          \
+    void * words[HANDY_TLIST_BATCH];                                                \
+                                                                                    \
+    for( int done = 0; done < count; )                                              \
+    {                                                                               \
+        int batch = count - done < HANDY_TLIST_BATCH ? count - done : HANDY_TLIST_BATCH; \
+                                                                                    \
+        for( int i = 0; i < batch; i++ )                                            \
+            words[i] = handy_list_##name##_box( items[done + i] );                  \
+                                                                                    \
+        if( !handy_list_add_back_n( &self->_base, words, batch ) )                  \
+        {                                                                           \
+            while( done-- > 0 )                                                     \
+                handy_list_rem_back( &self->_base );                                \
+            return false;                                                           \
+        }                                                                           \
+        done += batch;                                                              \
+    }                                                                               \
+    return true;                                                                    \
+}                                                                                   \
+bool handy_list_##name##_get_at     ( handy_list_##name self, int at, T * out )     \
+{                                                                                   \
+    if( at < 0 || at >= handy_list_length( &self->_base ) )                         \
+        return false;                                                               \
+                                                                                    \
+    *out = handy_list_##name##_unbox( handy_list_get_at( &self->_base, at ) );      \
+    return true;                                                                    \
+}                                                                                   \
+bool handy_list_##name##_rem_front  ( handy_list_##name self )                      \
+{                                                                                   \
+    return handy_list_rem_front( &self->_base );                                    \
+}                                                                                   \
+bool handy_list_##name##_rem_back   ( handy_list_##name self )                      \
+{                                                                                   \
+    return handy_list_rem_back( &self->_base );                                     \
+}                                                                                   \
+bool handy_list_##name##_rem_at     ( handy_list_##name self, int at )              \
+{                                                                                   \
+    return handy_list_rem_at( &self->_base, at );                                   \
+}                                                                                   \
+int  handy_list_##name##_tail       ( handy_list_##name self, T * out, int count )  \
+{                                                                                   \
+    handy_list_cursor cursor;                                                       \
+                                                                                    \
+    if( count > handy_list_length( &self->_base ) )                                 \
+        count = handy_list_length( &self->_base );                                  \
+                                                                                    \
+    handy_list_cursor_end( &self->_base, &cursor );                                 \
+    for( int i = count - 1; i >= 0; i--, handy_list_cursor_prev( &cursor ) )        \
+        out[i] = handy_list_##name##_unbox( handy_list_cursor_get( &cursor ) );     \
+    return count < 0 ? 0 : count;                                                   \
+}                                                                                   \
+int  handy_list_##name##_contain    ( handy_list_##name self, T item )              \
+{                                                                                   \
+    handy_list_cursor cursor;                                                       \
+                                                                                    \
+    /* equal bytes are equal item words, which the node list can look up */         \
+    if( self->_compare == NULL )                                                    \
+        return handy_list_contain( &self->_base, handy_list_##name##_box( item ) ); \
+                                                                                    \
+    handy_list_cursor_begin( &self->_base, &cursor );                               \
+    for( int index = 0; handy_list_cursor_valid( &cursor ); handy_list_cursor_next( &cursor ), index++ ) \
+    {                                                                               \
+        if( self->_compare( handy_list_##name##_unbox( handy_list_cursor_get( &cursor ) ), item ) == 0 ) \
+            return index;                                                           \
+    }                                                                               \
+    return -1;                                                                      \
+}                                                                                   \
+void handy_list_##name##_reverse    ( handy_list_##name self )                      \
+{                                                                                   \
+    handy_list_reverse( &self->_base );                                             \
+}                                                                                   \
+void handy_list_##name##_free       ( handy_list_##name self )                      \
+{                                                                                   \
+    handy_list_free( &self->_base );                                                \
+}
+
+HANDY_LIST_DECLARE( int, int )
+
+#endif //HANDY_TLIST_H
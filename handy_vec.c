@@ -0,0 +1,484 @@
+#include "handy_vec.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HANDY_VEC_X86 1
+#include <immintrin.h>
+#endif
+
+// search kernels: scalar versions first, they also finish the tails the
+// vector loops leave behind
+
+static long   handy_i32_find_scalar       ( const int32_t * items, size_t from, size_t count, int32_t item )
+{
+    for( size_t i = from; i < count; i++ )
+    {
+        if( items[i] == item )
+            return (long) i;
+    }
+    return -1;
+}
+static size_t handy_i32_count_scalar      ( const int32_t * items, size_t from, size_t count, int32_t item )
+{
+    size_t hits = 0;
+
+    for( size_t i = from; i < count; i++ )
+        hits += items[i] == item;
+    return hits;
+}
+static size_t handy_i32_count_even_scalar ( const int32_t * items, size_t from, size_t count )
+{
+    size_t hits = 0;
+
+    for( size_t i = from; i < count; i++ )
+        hits += ( items[i] & 1 ) == 0;
+    return hits;
+}
+// bit i of mask[ i / 64 ] set when items[i] is even; whole words are
+// written, bits past count cleared
+static void   handy_i32_even_mask_scalar  ( const int32_t * items, size_t from, size_t count, uint64_t * mask )
+{
+    for( size_t i = from; i < count; i++ )
+    {
+        if( i % 64 == 0 )
+            mask[ i / 64 ] = 0;
+        mask[ i / 64 ] |= (uint64_t)( ( items[i] & 1 ) == 0 ) << ( i % 64 );
+    }
+}
+static long   handy_i64_find_scalar       ( const int64_t * items, size_t from, size_t count, int64_t item )
+{
+    for( size_t i = from; i < count; i++ )
+    {
+        if( items[i] == item )
+            return (long) i;
+    }
+    return -1;
+}
+static size_t handy_i64_count_scalar      ( const int64_t * items, size_t from, size_t count, int64_t item )
+{
+    size_t hits = 0;
+
+    for( size_t i = from; i < count; i++ )
+        hits += items[i] == item;
+    return hits;
+}
+static size_t handy_i64_count_even_scalar ( const int64_t * items, size_t from, size_t count )
+{
+    size_t hits = 0;
+
+    for( size_t i = from; i < count; i++ )
+        hits += ( items[i] & 1 ) == 0;
+    return hits;
+}
+
+#ifdef HANDY_VEC_X86
+
+// lane counters are flushed before they can overflow
+#define HANDY_VEC_FLUSH ( (size_t) 1 << 30 )
+
+__attribute__(( target( "avx2" ) ))
+static long   handy_i32_find_avx2         ( const int32_t * items, size_t count, int32_t item )
+{
+    __m256i needle = _mm256_set1_epi32( item );
+    size_t  i = 0;
+
+    for( ; i + 32 <= count; i += 32 )
+    {
+        // four vectors per round, one branch
+        __m256i a = _mm256_cmpeq_epi32( _mm256_loadu_si256( (const __m256i *)( items + i ) ),      needle );
+        __m256i b = _mm256_cmpeq_epi32( _mm256_loadu_si256( (const __m256i *)( items + i + 8 ) ),  needle );
+        __m256i c = _mm256_cmpeq_epi32( _mm256_loadu_si256( (const __m256i *)( items + i + 16 ) ), needle );
+        __m256i d = _mm256_cmpeq_epi32( _mm256_loadu_si256( (const __m256i *)( items + i + 24 ) ), needle );
+
+        __m256i any = _mm256_or_si256( _mm256_or_si256( a, b ), _mm256_or_si256( c, d ) );
+        if( !_mm256_testz_si256( any, any ) )
+            return handy_i32_find_scalar( items, i, i + 32, item );
+    }
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m256i eq = _mm256_cmpeq_epi32( _mm256_loadu_si256( (const __m256i *)( items + i ) ), needle );
+        int     mask = _mm256_movemask_ps( _mm256_castsi256_ps( eq ) );
+
+        if( mask != 0 )
+            return (long)( i + __builtin_ctz( mask ) );
+    }
+    return handy_i32_find_scalar( items, i, count, item );
+}
+__attribute__(( target( "avx2" ) ))
+static size_t handy_i32_count_avx2        ( const int32_t * items, size_t count, int32_t item, bool even )
+{
+    __m256i needle = _mm256_set1_epi32( item );
+    __m256i one = _mm256_set1_epi32( 1 );
+    __m256i zero = _mm256_setzero_si256();
+    size_t  hits = 0;
+    size_t  i = 0;
+
+    while( i + 8 <= count )
+    {
+        __m256i acc = zero;
+        size_t  stop = count - i > HANDY_VEC_FLUSH ? i + HANDY_VEC_FLUSH : count;
+
+        for( ; i + 8 <= stop; i += 8 )
+        {
+            __m256i v = _mm256_loadu_si256( (const __m256i *)( items + i ) );
+            __m256i eq = even ? _mm256_cmpeq_epi32( _mm256_and_si256( v, one ), zero )
+                              : _mm256_cmpeq_epi32( v, needle );
+
+            // a match is -1 in its lane
+            acc = _mm256_sub_epi32( acc, eq );
+        }
+
+        int32_t lanes[8];
+        _mm256_storeu_si256( (__m256i *) lanes, acc );
+        for( int k = 0; k < 8; k++ )
+            hits += (uint32_t) lanes[k];
+    }
+    return hits + ( even ? handy_i32_count_even_scalar( items, i, count )
+                         : handy_i32_count_scalar( items, i, count, item ) );
+}
+static size_t handy_i32_count_sse2        ( const int32_t * items, size_t count, int32_t item, bool even )
+{
+    __m128i needle = _mm_set1_epi32( item );
+    __m128i one = _mm_set1_epi32( 1 );
+    __m128i zero = _mm_setzero_si128();
+    size_t  hits = 0;
+    size_t  i = 0;
+
+    while( i + 4 <= count )
+    {
+        __m128i acc = zero;
+        size_t  stop = count - i > HANDY_VEC_FLUSH ? i + HANDY_VEC_FLUSH : count;
+
+        for( ; i + 4 <= stop; i += 4 )
+        {
+            __m128i v = _mm_loadu_si128( (const __m128i *)( items + i ) );
+            __m128i eq = even ? _mm_cmpeq_epi32( _mm_and_si128( v, one ), zero )
+                              : _mm_cmpeq_epi32( v, needle );
+
+            acc = _mm_sub_epi32( acc, eq );
+        }
+
+        int32_t lanes[4];
+        _mm_storeu_si128( (__m128i *) lanes, acc );
+        for( int k = 0; k < 4; k++ )
+            hits += (uint32_t) lanes[k];
+    }
+    return hits + ( even ? handy_i32_count_even_scalar( items, i, count )
+                         : handy_i32_count_scalar( items, i, count, item ) );
+}
+__attribute__(( target( "avx2" ) ))
+static void   handy_i32_even_mask_avx2    ( const int32_t * items, size_t count, uint64_t * mask )
+{
+    __m256i one = _mm256_set1_epi32( 1 );
+    __m256i zero = _mm256_setzero_si256();
+    size_t  i = 0;
+
+    // one mask word from eight vectors
+    for( ; i + 64 <= count; i += 64 )
+    {
+        uint64_t bits = 0;
+
+        for( int k = 0; k < 8; k++ )
+        {
+            __m256i v = _mm256_loadu_si256( (const __m256i *)( items + i + 8 * k ) );
+            __m256i even = _mm256_cmpeq_epi32( _mm256_and_si256( v, one ), zero );
+
+            bits |= (uint64_t)(uint8_t) _mm256_movemask_ps( _mm256_castsi256_ps( even ) ) << ( 8 * k );
+        }
+        mask[ i / 64 ] = bits;
+    }
+    handy_i32_even_mask_scalar( items, i, count, mask );
+}
+static void   handy_i32_even_mask_sse2    ( const int32_t * items, size_t count, uint64_t * mask )
+{
+    __m128i one = _mm_set1_epi32( 1 );
+    __m128i zero = _mm_setzero_si128();
+    size_t  i = 0;
+
+    for( ; i + 64 <= count; i += 64 )
+    {
+        uint64_t bits = 0;
+
+        for( int k = 0; k < 16; k++ )
+        {
+            __m128i v = _mm_loadu_si128( (const __m128i *)( items + i + 4 * k ) );
+            __m128i even = _mm_cmpeq_epi32( _mm_and_si128( v, one ), zero );
+
+            bits |= (uint64_t) _mm_movemask_ps( _mm_castsi128_ps( even ) ) << ( 4 * k );
+        }
+        mask[ i / 64 ] = bits;
+    }
+    handy_i32_even_mask_scalar( items, i, count, mask );
+}
+static long   handy_i32_find_sse2         ( const int32_t * items, size_t count, int32_t item )
+{
+    __m128i needle = _mm_set1_epi32( item );
+    size_t  i = 0;
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128i eq = _mm_cmpeq_epi32( _mm_loadu_si128( (const __m128i *)( items + i ) ), needle );
+        int     mask = _mm_movemask_ps( _mm_castsi128_ps( eq ) );
+
+        if( mask != 0 )
+            return (long)( i + __builtin_ctz( mask ) );
+    }
+    return handy_i32_find_scalar( items, i, count, item );
+}
+__attribute__(( target( "avx2" ) ))
+static long   handy_i64_find_avx2         ( const int64_t * items, size_t count, int64_t item )
+{
+    __m256i needle = _mm256_set1_epi64x( item );
+    size_t  i = 0;
+
+    for( ; i + 16 <= count; i += 16 )
+    {
+        __m256i a = _mm256_cmpeq_epi64( _mm256_loadu_si256( (const __m256i *)( items + i ) ),      needle );
+        __m256i b = _mm256_cmpeq_epi64( _mm256_loadu_si256( (const __m256i *)( items + i + 4 ) ),  needle );
+        __m256i c = _mm256_cmpeq_epi64( _mm256_loadu_si256( (const __m256i *)( items + i + 8 ) ),  needle );
+        __m256i d = _mm256_cmpeq_epi64( _mm256_loadu_si256( (const __m256i *)( items + i + 12 ) ), needle );
+
+        __m256i any = _mm256_or_si256( _mm256_or_si256( a, b ), _mm256_or_si256( c, d ) );
+        if( !_mm256_testz_si256( any, any ) )
+            return handy_i64_find_scalar( items, i, i + 16, item );
+    }
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m256i eq = _mm256_cmpeq_epi64( _mm256_loadu_si256( (const __m256i *)( items + i ) ), needle );
+        int     mask = _mm256_movemask_pd( _mm256_castsi256_pd( eq ) );
+
+        if( mask != 0 )
+            return (long)( i + __builtin_ctz( mask ) );
+    }
+    return handy_i64_find_scalar( items, i, count, item );
+}
+__attribute__(( target( "avx2" ) ))
+static size_t handy_i64_count_avx2        ( const int64_t * items, size_t count, int64_t item, bool even )
+{
+    __m256i needle = _mm256_set1_epi64x( item );
+    __m256i one = _mm256_set1_epi64x( 1 );
+    __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    size_t  i = 0;
+
+    // 64-bit lanes cannot overflow here
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m256i v = _mm256_loadu_si256( (const __m256i *)( items + i ) );
+        __m256i eq = even ? _mm256_cmpeq_epi64( _mm256_and_si256( v, one ), zero )
+                          : _mm256_cmpeq_epi64( v, needle );
+
+        acc = _mm256_sub_epi64( acc, eq );
+    }
+
+    int64_t lanes[4];
+    size_t  hits = 0;
+
+    _mm256_storeu_si256( (__m256i *) lanes, acc );
+    for( int k = 0; k < 4; k++ )
+        hits += (size_t) lanes[k];
+
+    return hits + ( even ? handy_i64_count_even_scalar( items, i, count )
+                         : handy_i64_count_scalar( items, i, count, item ) );
+}
+
+static bool handy_vec_avx2      ()
+{
+    return __builtin_cpu_supports( "avx2" );
+}
+
+#endif // HANDY_VEC_X86
+
+long   handy_i32_find           ( const int32_t * items, size_t count, int32_t item )
+{
+#ifdef HANDY_VEC_X86
+    return handy_vec_avx2() ? handy_i32_find_avx2( items, count, item )
+                            : handy_i32_find_sse2( items, count, item );
+#else
+    return handy_i32_find_scalar( items, 0, count, item );
+#endif
+}
+size_t handy_i32_count          ( const int32_t * items, size_t count, int32_t item )
+{
+#ifdef HANDY_VEC_X86
+    return handy_vec_avx2() ? handy_i32_count_avx2( items, count, item, false )
+                            : handy_i32_count_sse2( items, count, item, false );
+#else
+    return handy_i32_count_scalar( items, 0, count, item );
+#endif
+}
+size_t handy_i32_count_even     ( const int32_t * items, size_t count )
+{
+#ifdef HANDY_VEC_X86
+    return handy_vec_avx2() ? handy_i32_count_avx2( items, count, 0, true )
+                            : handy_i32_count_sse2( items, count, 0, true );
+#else
+    return handy_i32_count_even_scalar( items, 0, count );
+#endif
+}
+void   handy_i32_even_mask      ( const int32_t * items, size_t count, uint64_t * mask )
+{
+#ifdef HANDY_VEC_X86
+    if( handy_vec_avx2() )
+        handy_i32_even_mask_avx2( items, count, mask );
+    else
+        handy_i32_even_mask_sse2( items, count, mask );
+#else
+    handy_i32_even_mask_scalar( items, 0, count, mask );
+#endif
+}
+// SSE2 has no 64-bit compare; without AVX2 the scalar loops are used
+long   handy_i64_find           ( const int64_t * items, size_t count, int64_t item )
+{
+#ifdef HANDY_VEC_X86
+    if( handy_vec_avx2() )
+        return handy_i64_find_avx2( items, count, item );
+#endif
+    return handy_i64_find_scalar( items, 0, count, item );
+}
+size_t handy_i64_count          ( const int64_t * items, size_t count, int64_t item )
+{
+#ifdef HANDY_VEC_X86
+    if( handy_vec_avx2() )
+        return handy_i64_count_avx2( items, count, item, false );
+#endif
+    return handy_i64_count_scalar( items, 0, count, item );
+}
+size_t handy_i64_count_even     ( const int64_t * items, size_t count )
+{
+#ifdef HANDY_VEC_X86
+    if( handy_vec_avx2() )
+        return handy_i64_count_avx2( items, count, 0, true );
+#endif
+    return handy_i64_count_even_scalar( items, 0, count );
+}
+
+// container: one buffer with room at both ends. When an end runs out the
+// values are re-centred, in place if the buffer is at most half used and
+// in a buffer twice the size otherwise, which keeps both ends amortized
+// O(1).
+
+#define HANDY_VEC_MIN_CAP 16
+
+#define HANDY_VEC_DEFINE( T, name )                                                 \
+                                                                                    \
+handy_vec_##name handy_create_vec_##name ()                                         \
+{                                                                                   \
+    handy_vec_##name temp_vec = malloc( sizeof(*temp_vec) );                        \
+    if( temp_vec == NULL )                                                          \
+        return NULL;                                                                \
+                                                                                    \
+    temp_vec->_data = NULL;                                                         \
+    temp_vec->_begin = temp_vec->_end = temp_vec->_cap = 0;                         \
+    return temp_vec;                                                                \
+}                                                                                   \
+/* make room for need more values at the front or the back */                       \
+static bool handy_vec_##name##_reserve ( handy_vec_##name self, size_t need, bool front ) \
+{                                                                                   \
+    size_t length = self->_end - self->_begin;                                      \
+    size_t cap = self->_cap;                                                        \
+    T *    data = self->_data;                                                      \
+                                                                                    \
+    if( ( length + need ) * 2 > cap )                                               \
+    {                                                                               \
+        cap = cap < HANDY_VEC_MIN_CAP ? HANDY_VEC_MIN_CAP : cap * 2;                \
+        while( ( length + need ) * 2 > cap )                                        \
+            cap *= 2;                                                               \
+                                                                                    \
+        data = malloc( cap * sizeof( T ) );                                         \
+        if( data == NULL )                                                          \
+            return false;                                                           \
+    }                                                                               \
+                                                                                    \
+    /* the growing end gets the larger share of the spare room */                   \
+    size_t spare = cap - length - need;                                             \
+    size_t begin = front ? need + spare * 3 / 4 : spare / 4;                        \
+                                                                                    \
+    if( length > 0 )                                                                \
+        memmove( data + begin, self->_data + self->_begin, length * sizeof( T ) );  \
+                                                                                    \
+    if( data != self->_data )                                                       \
+        free( self->_data );                                                        \
+                                                                                    \
+    self->_data = data;                                                             \
+    self->_cap = cap;                                                               \
+    self->_begin = begin;                                                           \
+    self->_end = begin + length;                                                    \
+    return true;                                                                    \
+}                                                                                   \
+bool   handy_vec_##name##_push_back   ( handy_vec_##name self, T item )             \
+{                                                                                   \
+    if( self->_end == self->_cap && !handy_vec_##name##_reserve( self, 1, false ) ) \
+        return false;                                                               \
+                                                                                    \
+    self->_data[ self->_end++ ] = item;                                             \
+    return true;                                                                    \
+}                                                                                   \
+bool   handy_vec_##name##_push_front  ( handy_vec_##name self, T item )             \
+{                                                                                   \
+    if( self->_begin == 0 && !handy_vec_##name##_reserve( self, 1, true ) )         \
+        return false;                                                               \
+                                                                                    \
+    self->_data[ --self->_begin ] = item;                                           \
+    return true;                                                                    \
+}                                                                                   \
+bool   handy_vec_##name##_push_back_n ( handy_vec_##name self, const T * items, size_t count ) \
+{                                                                                   \
+    if( self->_cap - self->_end < count &&                                          \
+        !handy_vec_##name##_reserve( self, count, false ) )                         \
+        return false;                                                               \
+                                                                                    \
+    memcpy( self->_data + self->_end, items, count * sizeof( T ) );                 \
+    self->_end += count;                                                            \
+    return true;                                                                    \
+}                                                                                   \
+bool   handy_vec_##name##_pop_back    ( handy_vec_##name self, T * item )           \
+{                                                                                   \
+    if( self->_end == self->_begin )                                                \
+        return false;                                                               \
+                                                                                    \
+    self->_end--;                                                                   \
+    if( item != NULL )                                                              \
+        *item = self->_data[ self->_end ];                                          \
+    return true;                                                                    \
+}                                                                                   \
+bool   handy_vec_##name##_pop_front   ( handy_vec_##name self, T * item )           \
+{                                                                                   \
+    if( self->_end == self->_begin )                                                \
+        return false;                                                               \
+                                                                                    \
+    if( item != NULL )                                                              \
+        *item = self->_data[ self->_begin ];                                        \
+    self->_begin++;                                                                 \
+    return true;                                                                    \
+}                                                                                   \
+long   handy_vec_##name##_find        ( handy_vec_##name self, T item )             \
+{                                                                                   \
+    return handy_##name##_find( self->_data + self->_begin, self->_end - self->_begin, item ); \
+}                                                                                   \
+bool   handy_vec_##name##_contain     ( handy_vec_##name self, T item )             \
+{                                                                                   \
+    return handy_vec_##name##_find( self, item ) >= 0;                              \
+}                                                                                   \
+size_t handy_vec_##name##_count       ( handy_vec_##name self, T item )             \
+{                                                                                   \
+    return handy_##name##_count( self->_data + self->_begin, self->_end - self->_begin, item ); \
+}                                                                                   \
+size_t handy_vec_##name##_count_even  ( handy_vec_##name self )                     \
+{                                                                                   \
+    return handy_##name##_count_even( self->_data + self->_begin, self->_end - self->_begin ); \
+}                                                                                   \
+void   handy_vec_##name##_clear       ( handy_vec_##name self )                     \
+{                                                                                   \
+    self->_begin = self->_end = self->_cap / 2;                                     \
+}                                                                                   \
+void   handy_vec_##name##_free        ( handy_vec_##name self )                     \
+{                                                                                   \
+    free( self->_data );                                                            \
+    self->_data = NULL;                                                             \
+    self->_begin = self->_end = self->_cap = 0;                                     \
+}
+
+HANDY_VEC_DEFINE( int32_t, i32 )
+HANDY_VEC_DEFINE( int64_t, i64 )
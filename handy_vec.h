@@ -0,0 +1,79 @@
+// header definition of handy_vec( contiguous growable vector ) data structure
+//
+// Typed storage for scalar payloads: the values sit side by side in one
+// buffer with free room kept at both ends, so push and pop at either end
+// are amortized O(1) and data() is always one contiguous array. find,
+// contain, count and count_even run SIMD kernels ( AVX2 or SSE2, picked
+// at run time ) with a scalar fallback.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef HANDY_VEC_H
+#define HANDY_VEC_H
+
+#define HANDY_VEC_DECLARE( T, name )                                                \
+                                                                                    \
+typedef struct _handy_vec_##name##_struct * handy_vec_##name;                       \
+                                                                                    \
+struct _handy_vec_##name##_struct                                                   \
+{                                                                                   \
+    T *    _data;                                                                   \
+    size_t _begin;                  /* first used slot */                           \
+    size_t _end;                    /* one past the last used slot */               \
+    size_t _cap;                                                                    \
+};                                                                                  \
+                                                                                    \
+extern handy_vec_##name handy_create_vec_##name();                                  \
+                                                                                    \
+extern bool   handy_vec_##name##_push_back  ( handy_vec_##name self, T item );      \
+extern bool   handy_vec_##name##_push_front ( handy_vec_##name self, T item );      \
+extern bool   handy_vec_##name##_push_back_n( handy_vec_##name self, const T * items, size_t count ); \
+extern bool   handy_vec_##name##_pop_back   ( handy_vec_##name self, T * item );    \
+extern bool   handy_vec_##name##_pop_front  ( handy_vec_##name self, T * item );    \
+extern long   handy_vec_##name##_find       ( handy_vec_##name self, T item );      \
+extern bool   handy_vec_##name##_contain    ( handy_vec_##name self, T item );      \
+extern size_t handy_vec_##name##_count      ( handy_vec_##name self, T item );      \
+extern size_t handy_vec_##name##_count_even ( handy_vec_##name self );              \
+extern void   handy_vec_##name##_clear      ( handy_vec_##name self );              \
+extern void   handy_vec_##name##_free       ( handy_vec_##name self );              \
+                                                                                    \
+static inline size_t handy_vec_##name##_length ( handy_vec_##name self )            \
+{                                                                                   \
+    return self->_end - self->_begin;                                               \
+}                                                                                   \
+static inline bool   handy_vec_##name##_empty  ( handy_vec_##name self )            \
+{                                                                                   \
+    return self->_end == self->_begin;                                              \
+}                                                                                   \
+static inline T *    handy_vec_##name##_data   ( handy_vec_##name self )            \
+{                                                                                   \
+    return self->_data + self->_begin;                                              \
+}                                                                                   \
+/* at must be below length */                                                       \
+static inline T      handy_vec_##name##_get_at ( handy_vec_##name self, size_t at ) \
+{                                                                                   \
+    return self->_data[ self->_begin + at ];                                        \
+}                                                                                   \
+static inline void   handy_vec_##name##_set_at ( handy_vec_##name self, size_t at, T item ) \
+{                                                                                   \
+    self->_data[ self->_begin + at ] = item;                                        \
+}
+
+HANDY_VEC_DECLARE( int32_t, i32 )
+HANDY_VEC_DECLARE( int64_t, i64 )
+
+// the kernels on their own, for any array of that type
+extern long   handy_i32_find        ( const int32_t * items, size_t count, int32_t item );
+extern size_t handy_i32_count       ( const int32_t * items, size_t count, int32_t item );
+extern size_t handy_i32_count_even  ( const int32_t * items, size_t count );
+// bit i of mask[ i / 64 ] set when items[i] is even; mask holds
+// ( count + 63 ) / 64 words, and bits past count are cleared
+extern void   handy_i32_even_mask   ( const int32_t * items, size_t count, uint64_t * mask );
+extern long   handy_i64_find        ( const int64_t * items, size_t count, int64_t item );
+extern size_t handy_i64_count       ( const int64_t * items, size_t count, int64_t item );
+extern size_t handy_i64_count_even  ( const int64_t * items, size_t count );
+
+#endif //HANDY_VEC_H
@@ -5,8 +5,10 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "handy_list.h"
+#include "handy_tlist.h"
+#include "handy_vec.h"
 
-handy_list list;
+handy_list_int list;
 //copied from list of objects but corrected for list of relations
 
 //function prototypes
@@ -34,21 +36,278 @@ bool threeArg(int x,int y,int z)
 	return true;
 }
 
-// relations defined as union because the relations are not of thesame same type hence need for an appropriate structure that can hold the various types of relations
-union relations
-{			
-	int (*ref)(int x);
-	int (*sym)(int x,int y);
+// relation registry: every relation has an id, an arity, the window of the
+// list it reads and a signature. The relations known at compile time are
+// called by id through a switch, so the compiler sees a direct call it can
+// inline and admission makes no indirect calls; RELATION_ENTRY checks the
+// signature against the function itself: an entry that disagrees with it
+// does not compile. Any other relation, of any arity up to RELATION_ARGS,
+// is registered at run time with registerRelation and takes its arguments
+// as an array, at the cost of one indirect call. A frame attaches any set
+// of relations at once ( a union could only keep the last one ).
+enum relation_id
+{
+	REL_REFLEXIVITY,
+	REL_SYMMETRY,
+	REL_ONE_ARG,
+	REL_TWO_ARG,
+	REL_THREE_ARG,
+
+	REL_COUNT
+};
+
+#define RELATION_MAX 32		// ids a relation set has bits for
+#define RELATION_ARGS 16	// the widest arity a relation may have
+
+// where a relation's arguments come from; the new item is always last
+enum relation_window
+{
+	WINDOW_LAST_K,			// the arity - 1 newest items, oldest first
+	WINDOW_FIRST_LAST		// the newest and the oldest item ( arity 3 only )
+};
+
+// a relation registered at run time: args holds arity arguments
+typedef bool (*relation_fn)( const int * args, int arity );
+
+struct relation_entry
+{
+	enum relation_id id;
+	const char * name;
+	int arity;
+	enum relation_window window;
+	const char * signature;
+	relation_fn fn;			// NULL for the relations of the switch
+};
+
+#define RELATION_ENTRY( id, fn, arity, window, ret, params ) \
+	{ id, #fn, arity, window, _Generic( &fn, ret (*) params: #ret #params ), NULL }
+
+static int relationCount = REL_COUNT;
+
+static struct relation_entry relationRegistry[RELATION_MAX] =
+{
+	RELATION_ENTRY( REL_REFLEXIVITY, reflexivity, 1, WINDOW_LAST_K,     int,  (int) ),
+	RELATION_ENTRY( REL_SYMMETRY,    symmetry,    2, WINDOW_LAST_K,     int,  (int,int) ),
+	RELATION_ENTRY( REL_ONE_ARG,     oneArg,      1, WINDOW_LAST_K,     bool, (int) ),
+	RELATION_ENTRY( REL_TWO_ARG,     twoArg,      2, WINDOW_LAST_K,     bool, (int,int) ),
+	RELATION_ENTRY( REL_THREE_ARG,   threeArg,    3, WINDOW_FIRST_LAST, bool, (int,int,int) ),
+};
+
+// whether the window of a relation yields its arity - 1 items once the
+// list is long enough
+static bool relationFits( const struct relation_entry * rel )
+{
+	if( rel->arity < 1 || rel->arity > RELATION_ARGS )
+		return false;
+
+	return rel->window != WINDOW_FIRST_LAST || rel->arity == 3;
+}
+
+// args holds relationRegistry[id].arity arguments; id is registered
+static inline bool relationHolds( enum relation_id id, const int * args )
+{
+	switch( id )
+	{
+		case REL_REFLEXIVITY: return reflexivity(args[0]) != 0;
+		case REL_SYMMETRY:    return symmetry(args[0], args[1]) != 0;
+		case REL_ONE_ARG:     return oneArg(args[0]);
+		case REL_TWO_ARG:     return twoArg(args[0], args[1]);
+		case REL_THREE_ARG:   return threeArg(args[0], args[1], args[2]);
+		default:              return relationRegistry[id].fn(args, relationRegistry[id].arity);
+	}
+}
+
+// the relations attached to a frame, one bit per id
+struct relation_set
+{
+	unsigned attached;
 };
 
-union relations R;
+struct relation_set R;
+
+// false, leaving R alone, for an unknown id or a relation whose arity its
+// window cannot fill
+bool attachRelation( struct relation_set * R, enum relation_id id )
+{
+	if( (unsigned)id >= (unsigned)relationCount || !relationFits(&relationRegistry[id]) )
+		return false;
 
- void init( union relations * R )
+	R->attached |= 1u << id;
+	return true;
+}
+
+// add a relation taking arity arguments, read through window, and return
+// its id; -1 when fn is NULL, the window cannot fill arity or all
+// RELATION_MAX ids are taken
+int registerRelation( const char * name, int arity, enum relation_window window, relation_fn fn )
+{
+	struct relation_entry rel = { relationCount, name, arity, window, "bool(const int *,int)", fn };
+
+	if( fn == NULL || relationCount == RELATION_MAX || !relationFits(&rel) )
+		return -1;
+
+	relationRegistry[relationCount] = rel;
+	return relationCount++;
+}
+
+ void init( struct relation_set * R )
  {
- 	R->ref = reflexivity;
-    R->sym = symmetry;
+ 	R->attached = 0;
+ 	attachRelation(R, REL_REFLEXIVITY);
+    attachRelation(R, REL_SYMMETRY);
  }
 
+// Memo cache: an opt-in, bounded table of earlier results keyed by
+// ( relation id, arguments ), so a repeated check costs one probe. Only
+// relations marked pure ( same arguments, same result, no side effects )
+// are cached, and only up to MEMO_ARGS arguments. Keys hash to a bucket of
+// MEMO_WAYS entries; a full bucket evicts by CLOCK, skipping entries hit
+// since the hand last passed them.
+#define MEMO_ARGS 4
+#define MEMO_WAYS 8
+
+struct memo_entry
+{
+	int args[MEMO_ARGS];
+	unsigned char id;		// relation id + 1, 0 when empty
+	bool result;
+	bool referenced;		// hit since the clock hand last passed
+};
+
+struct memo_stats
+{
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long evictions;
+};
+
+struct relation_memo
+{
+	struct memo_entry * entries;	// buckets of MEMO_WAYS
+	size_t buckets;					// a power of two
+	unsigned char * hands;			// clock hand per bucket
+	struct memo_stats stats;
+};
+
+static struct relation_memo relationMemo;
+static unsigned relationPure;		// one bit per relation id
+
+void markRelationPure( enum relation_id id, bool pure )
+{
+	if( pure )
+		relationPure |= 1u << id;
+	else
+		relationPure &= ~( 1u << id );
+}
+
+// start caching with room for about capacity results, dropping any cache
+// there was; false when out of memory
+bool memoEnable( size_t capacity )
+{
+	size_t buckets = 1;
+
+	while( buckets * MEMO_WAYS < capacity )
+		buckets *= 2;
+
+	struct memo_entry * entries = calloc(buckets * MEMO_WAYS, sizeof(struct memo_entry));
+	unsigned char * hands = calloc(buckets, 1);
+
+	if( entries == NULL || hands == NULL )
+	{
+		free(entries);
+		free(hands);
+		return false;
+	}
+
+	free(relationMemo.entries);
+	free(relationMemo.hands);
+
+	relationMemo.entries = entries;
+	relationMemo.hands = hands;
+	relationMemo.buckets = buckets;
+	memset(&relationMemo.stats, 0, sizeof(relationMemo.stats));
+	return true;
+}
+
+void memoDisable()
+{
+	free(relationMemo.entries);
+	free(relationMemo.hands);
+	memset(&relationMemo, 0, sizeof(relationMemo));
+}
+
+void memoStats( struct memo_stats * out )
+{
+	*out = relationMemo.stats;
+}
+
+static size_t memoBucket( enum relation_id id, const int * args, int arity )
+{
+	uint64_t hash = (uint64_t)id * 0x9e3779b97f4a7c15ull;
+
+	for( int i = 0; i < arity; i++ )
+		hash = ( hash ^ (uint32_t)args[i] ) * 0xff51afd7ed558ccdull;
+
+	return ( hash ^ ( hash >> 32 ) ) & ( relationMemo.buckets - 1 );
+}
+
+// relationHolds through the memo cache, when it is on and id is pure
+static bool relationCheck( enum relation_id id, const int * args )
+{
+	int arity = relationRegistry[id].arity;
+
+	if( relationMemo.entries == NULL || ( relationPure & ( 1u << id ) ) == 0 || arity > MEMO_ARGS )
+		return relationHolds(id, args);
+
+	size_t bucket = memoBucket(id, args, arity);
+	struct memo_entry * ways = relationMemo.entries + bucket * MEMO_WAYS;
+	struct memo_entry * empty = NULL;
+
+	for( int w = 0; w < MEMO_WAYS; w++ )
+	{
+		if( ways[w].id == 0 )
+		{
+			if( empty == NULL )
+				empty = &ways[w];
+		}
+		else if( ways[w].id == id + 1 && memcmp(ways[w].args, args, arity * sizeof(int)) == 0 )
+		{
+			relationMemo.stats.hits++;
+			ways[w].referenced = true;
+			return ways[w].result;
+		}
+	}
+
+	relationMemo.stats.misses++;
+
+	bool result = relationHolds(id, args);
+
+	if( empty == NULL )
+	{
+		// second chance: clear referenced entries until the hand finds one
+		// that was not hit
+		unsigned char * hand = &relationMemo.hands[bucket];
+
+		while( ways[*hand].referenced )
+		{
+			ways[*hand].referenced = false;
+			*hand = ( *hand + 1 ) % MEMO_WAYS;
+		}
+		empty = &ways[*hand];
+		*hand = ( *hand + 1 ) % MEMO_WAYS;
+
+		relationMemo.stats.evictions++;
+	}
+
+	memset(empty->args, 0, sizeof(empty->args));
+	memcpy(empty->args, args, arity * sizeof(int));
+	empty->id = id + 1;
+	empty->result = result;
+	empty->referenced = false;
+
+	return result;
+}
+
 
 
 //define relations for just one operation(even) for now
@@ -71,11 +330,68 @@ when we have just one element in the list then we want to call checkRelation1 he
 same thing happens when we have two elemnents and so on. 
 In the end we can come up with a general formular to check relations while we go through the list of elements 
 */
+
+// the general formula: a relation reads its arguments from a window of the
+// list, the new item always last. Only the one new tuple the item completes
+// is evaluated, and the window is read from the ends of the list, so
+// admitting an item costs O(arity) whatever the list length. A relation
+// the list is still too short for has no such tuple yet.
+
+// append item to list when every relation attached to set holds for the
+// tuple it completes. The newest items are read once for all of the
+// relations, and pure ones go through the memo cache when it is on.
+bool admitAttached( handy_list_int list, const struct relation_set * set, int item )
+{
+	int args[RELATION_ARGS];
+	int ends[3];
+	int widest = 1;
+
+	for( unsigned bits = set->attached; bits != 0; bits &= bits - 1 )
+	{
+		const struct relation_entry * rel = &relationRegistry[__builtin_ctz(bits)];
+		if( rel->window == WINDOW_LAST_K && rel->arity > widest )
+			widest = rel->arity;
+	}
+
+	// args: the newest items, oldest first, then item
+	int window = handy_list_int_tail(list, args, widest - 1);
+	args[window] = item;
+
+	for( unsigned bits = set->attached; bits != 0; bits &= bits - 1 )
+	{
+		enum relation_id id = __builtin_ctz(bits);
+		int arity = relationRegistry[id].arity;
+
+		if( relationRegistry[id].window == WINDOW_FIRST_LAST )
+		{
+			if( handy_list_int_length(list) < 2 )
+				continue;
+
+			handy_list_int_get_back(list, &ends[0]);
+			handy_list_int_get_front(list, &ends[1]);
+			ends[2] = item;
+
+			if( relationCheck(id, ends) == false )
+				return false;
+		}
+		else if( window >= arity - 1 && relationCheck(id, args + window + 1 - arity) == false )
+			return false;
+	}
+	return handy_list_int_add_back(list, item);
+}
+
+// append item to list when relation id holds for the tuple it completes
+bool admitItem( handy_list_int list, enum relation_id id, int item )
+{
+	struct relation_set one = { 0 };
+
+	return attachRelation(&one, id) && admitAttached(list, &one, item);
+}
+
 void checkRelation1( int item )
 {	
-	if( oneArg(item) == true )
+	if( admitItem(list, REL_ONE_ARG, item) == true )
 	{
-		list->add_back(list, item);
         printf("Add success\n");
 	}
 	else
@@ -86,51 +402,104 @@ void checkRelation1( int item )
 
 void checkRelation2(int item)
 {	
-
-	if( list->length(list) == 0 )
+	// nothing to pair item with yet: it is checked on its own
+	if( handy_list_int_empty(list) )
 	{
 		checkRelation1(item);
+		return;
 	}
-	else
+
+	if( admitItem(list, REL_TWO_ARG, item) == false )
 	{
-		int any = list->get_back(list);
-		
-		if( twoArg(any, item) == true )
-		{
-			list->add_back(list, item);
-		}
-		else
-		{	
-			printf("ERROR");
-		}
+		printf("ERROR");
 	}
 }
 
 void checkRelation3(int item)
 {	
-
-	if( list->length(list) == 0 )
+	if( handy_list_int_length(list) < 2 )
 	{
-		checkRelation1(item);
+		checkRelation2(item);
+		return;
 	}
-	else if( list->length(list) == 1 )
+
+	if( admitItem(list, REL_THREE_ARG, item) == false )
 	{
-		checkRelation2( item );
+		printf("ERROR");
 	}
-	else
+}
+
+// Batch admission: every item of items is offered in order, as admitItem
+// would, and bit i of accepted ( ( count + 63 ) / 64 words ) tells whether
+// items[i] went in. Returns how many did, or -1 when out of memory, in
+// which case nothing was appended.
+//
+// For oneArg and twoArg the decisions do not depend on one another: an
+// item is taken when it is even ( oneArg ) or when the item before it in
+// the batch, or the list's back for the first one, is even ( twoArg ),
+// since whichever of the two was taken last was that one; on an empty list
+// twoArg has no pair yet and takes the first item. That is one SIMD parity
+// mask and a shift, and the accepted items go in with a single bulk
+// append. Other relations are evaluated item by item.
+int admitBatch( handy_list_int list, enum relation_id id, const int * items, int count, uint64_t * accepted )
+{
+	int words = ( count + 63 ) / 64;
+	int taken = 0;
+
+	if( count <= 0 )
+		return 0;
+
+	if( id != REL_ONE_ARG && id != REL_TWO_ARG )
 	{
-		int any1 = list->get_back(list);
-		int any2 = list->get_front(list);
-		
-		if( threeArg(any1, any2, item) == true )
+		memset(accepted, 0, words * sizeof(uint64_t));
+		for( int i = 0; i < count; i++ )
 		{
-			list->add_back(list, item);
+			if( admitItem(list, id, items[i]) == true )
+			{
+				accepted[i / 64] |= (uint64_t)1 << (i % 64);
+				taken++;
+			}
 		}
-		else
-		{	
-			printf("ERROR");
+		return taken;
+	}
+
+	handy_i32_even_mask((const int32_t *)items, count, accepted);
+
+	if( id == REL_TWO_ARG )
+	{
+		int back;
+		uint64_t carry = handy_list_int_get_back(list, &back) ? oneArg(back) : 1;
+
+		for( int w = 0; w < words; w++ )
+		{
+			uint64_t even = accepted[w];
+
+			accepted[w] = even | (even << 1) | carry;
+			carry = even >> 63;
 		}
+		// the shift may carry the last item into a bit past count
+		if( count % 64 != 0 )
+			accepted[words - 1] &= ((uint64_t)1 << (count % 64)) - 1;
 	}
+
+	for( int w = 0; w < words; w++ )
+		taken += __builtin_popcountll(accepted[w]);
+
+	int * gathered = malloc(( taken > 0 ? taken : 1 ) * sizeof(int));
+	if( gathered == NULL )
+		return -1;
+
+	int n = 0;
+	for( int w = 0; w < words; w++ )
+	{
+		for( uint64_t bits = accepted[w]; bits != 0; bits &= bits - 1 )
+			gathered[n++] = items[w * 64 + __builtin_ctzll(bits)];
+	}
+
+	bool appended = handy_list_int_add_back_n(list, gathered, taken);
+
+	free(gathered);
+	return appended ? taken : -1;
 }
 
 
@@ -1,12 +1,14 @@
 #include <stdio.h>
 #include "listADT.c"
 #include "listOfRelationsADT.c"
+#include "handy_ilist.h"
 
 
 //define a record data structure for a frame(record data structure)
 struct frame{
     handy_list object;
-    union relations R;
+    struct relation_set R;      // relations attached to the frame
+    struct handy_ilink link;    // chains frames in a handy_ilist, no wrapper node
 };
 
 int main()
@@ -15,7 +17,7 @@ int main()
 
     init(&frm.R);
 
-    list = handy_create_list();
+    list = handy_create_list_int( NULL );
 
     int item;
 
@@ -23,17 +25,24 @@ int main()
     printf("Enter int: ");
     scanf("%d", &item);
 
-    frm.R.ref(item );
-
-    checkRelation1( item );
+    // the first item goes through the relations attached to the frame
+    if( admitAttached( list, &frm.R, item ) )
+        printf("Add success\n");
+    else
+        printf("ERROR");
 
     printf("Enter int: ");
     scanf("%d", &item);
 
     checkRelation1( item );
 
-    printf("list: %d", list->get_front(list) );
-    printf("list: %d", list->get_back(list) );
+    if( !handy_list_int_empty(list) )
+    {
+        handy_list_int_get_front(list, &item);
+        printf("list: %d", item );
+        handy_list_int_get_back(list, &item);
+        printf("list: %d", item );
+    }
 
 }
 